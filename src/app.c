@@ -39,6 +39,8 @@ i32 app_init()
     aud_init();
     assets_init();
     marena_init(&APP->ma, APP->mem, sizeof(APP->mem));
+    asset_jobs_init();
+    assets_res_init(ASSETS_RES_BUDGET);
     pltf_audio_set_volume(1.f);
     pltf_accelerometer_set(1);
     inp_init();
@@ -74,6 +76,8 @@ static void app_tick_step();
 
 void app_tick()
 {
+    asset_jobs_update();
+    assets_res_tick();
     app_tick_step();
     aud_cmd_queue_commit();
 }
@@ -102,7 +106,10 @@ static void app_tick_step()
         break;
     }
     case APP_ST_LOAD: {
-        APP->state = APP_ST_GAME;
+        // keep ticking while the assets are loaded in the background
+        if (!asset_jobs_busy()) {
+            APP->state = APP_ST_GAME;
+        }
         break;
     }
     case APP_ST_TITLE: {
@@ -110,7 +117,9 @@ static void app_tick_step()
         break;
     }
     case APP_ST_GAME: {
+        coll_prof_tick_begin();
         game_tick(g);
+        coll_prof_tick_end(g);
         break;
     }
     }
@@ -142,6 +151,8 @@ void app_draw()
 
 void app_close()
 {
+    coll_prof_report();
+    asset_jobs_destroy();
     aud_destroy();
     if (APP_MEM_RAW) {
         pltf_mem_free(APP_MEM_RAW);
@@ -6,6 +6,8 @@
 #define APP_H
 
 #include "core/assets.h"
+#include "core/assets_jobs.h"
+#include "core/assets_res.h"
 #include "core/aud.h"
 #include "core/spm.h"
 #include "game.h"
@@ -35,14 +37,16 @@ enum {
 
 typedef struct {
     ALIGNAS(APP_STRUCT_ALIGNMENT)
-    wad_s    wad;
-    assets_s assets;
-    spm_s    spm;
-    aud_s    aud;
-    g_s      game;
-    title_s  title;
-    i32      state;
-    marena_s ma;
+    wad_s        wad;
+    assets_s     assets;
+    asset_jobs_s jobs;
+    assets_res_s res;
+    spm_s        spm;
+    aud_s        aud;
+    g_s          game;
+    title_s      title;
+    i32          state;
+    marena_s     ma;
 
     byte mem[MMEGABYTE(8)];
 } app_s;
@@ -4,12 +4,6 @@
 
 #include "app_load.h"
 
-typedef struct {
-    void       *f;
-    wad_el_s   *e;
-    allocator_s allocator;
-} app_load_s;
-
 i32 app_texID_create_put(i32 ID, i32 w, i32 h, b32 mask, allocator_s a, tex_s *o_t)
 {
     tex_s t = {0};
@@ -23,51 +17,90 @@ i32 app_texID_create_put(i32 ID, i32 w, i32 h, b32 mask, allocator_s a, tex_s *o
     return r;
 }
 
-static i32 app_load_tex_internal(app_load_s l, i32 ID, const void *name)
+// small object sprites, candidates for the atlas pages
+static const struct {
+    i32         ID;
+    const char *name;
+} app_sprites[] = {
+    {TEXID_SWITCH, "T_SWITCH"},
+    {TEXID_TOGGLE, "T_TOGGLE"},
+    {TEXID_CHEST, "T_CHEST"},
+    {TEXID_CRUMBLE, "T_CRUMBL"},
+    {TEXID_TRAMPOLINE, "T_TRAMPO"},
+    {TEXID_STALACTITE, "T_STALAC"},
+    {TEXID_STAMINARESTORE, "T_STAMRE"},
+    {TEXID_BUDPLANT, "T_BUDPLA"},
+    {TEXID_SAVEPOINT, "T_SAVEPT"},
+    {TEXID_HOOK, "T_HOOK"},
+};
+
+static void app_load_water_prerender(void *ctx)
 {
-    tex_s *t = &APP->assets.tex[ID].tex;
-    i32    r = tex_from_wad(l.f, l.e, name, l.allocator, t);
-    if (r != 0) {
-        pltf_log("ERROR LOADING TEX: %i\n", r);
-    }
-    return r;
+    water_prerender_tiles();
 }
 
-static i32 app_load_snd_internal(app_load_s l, i32 ID, const void *name)
+// atlas pages of small sprites, if the wad was exported with them
+static void app_load_atlas(void *ctx)
 {
-    snd_s *s = &APP->assets.snd[ID].snd;
-    i32    r = snd_from_wad(l.f, l.e, name, l.allocator, s);
-    if (r != 0) {
-        pltf_log("ERROR LOADING SND: %i\n", r);
-    }
-    return r;
+    wad_el_s *e = (wad_el_s *)ctx;
+    void     *f = pltf_file_open_r((const char *)e->filename);
+    if (!f) return;
+    assets_atlas_from_wad(f, e, app_allocator());
+    pltf_file_close(f);
 }
 
+// queues the loading jobs and returns immediately
+// poll asset_jobs_busy() or wait with asset_jobs_wait_all()
 i32 app_load_assets()
 {
-    void     *f = 0;
-    wad_el_s *e = 0;
-
-    if (!wad_open_str("WAD_MAIN", &f, &e)) return -1;
+    wad_el_s *e = wad_el_find(wad_hash("WAD_MAIN"), 0);
+    if (!e) return -1;
 
-    app_load_s l = {f, 0, app_allocator()};
-    i32        r = 0;
+    allocator_s a = app_allocator();
 
     // TEX ---------------------------------------------------------------------
-    l.e = wad_seek_str(f, e, "WAD_TEX");
-    if (l.e) {
-        r |= app_load_tex_internal(l, TEXID_TILESET_TERRAIN, "T_TSTERR");
-        r |= app_load_tex_internal(l, TEXID_TILESET_BG_AUTO, "T_TSBGA");
-        r |= app_load_tex_internal(l, TEXID_TILESET_PROPS, "T_TSPROP");
-        r |= app_load_tex_internal(l, TEXID_TILESET_DECO, "T_TSDECO");
-        r |= app_load_tex_internal(l, TEXID_HERO, "T_HERO");
+    wad_el_s *etex = wad_el_find(wad_hash("WAD_TEX"), e);
+    if (etex) {
+        // first: the texture jobs skip what is on an atlas page
+        asset_job_func(app_load_atlas, etex);
+        asset_job_tex(TEXID_TILESET_TERRAIN, etex, "T_TSTERR", a);
+        asset_job_tex(TEXID_TILESET_BG_AUTO, etex, "T_TSBGA", a);
+        asset_job_tex(TEXID_TILESET_PROPS, etex, "T_TSPROP", a);
+        asset_job_tex(TEXID_TILESET_DECO, etex, "T_TSDECO", a);
+        asset_job_tex(TEXID_HERO, etex, "T_HERO", a);
+        for (i32 n = 0; n < ARRLEN(app_sprites); n++) {
+            asset_job_tex_opt(app_sprites[n].ID, etex, app_sprites[n].name, a);
+        }
     }
 
-    water_prerender_tiles();
+    asset_job_func(app_load_water_prerender, 0);
+
+    // area backgrounds are loaded on first use and may be evicted
+    if (etex) {
+        assets_res_tex(TEXID_BG_MOUNTAINS, etex, "T_BGMNT");
+        assets_res_tex(TEXID_BG_CAVE, etex, "T_BGCAV");
+        assets_res_tex(TEXID_BG_CAVE_DEEP, etex, "T_BGCDP");
+        assets_res_tex(TEXID_BG_FOREST, etex, "T_BGFOR");
+    }
 
     // SND ---------------------------------------------------------------------
-    // r |= app_load_snd_internal(l, TEXID_TILESET_TERRAIN, "TSTERR");
+    // asset_job_snd(SNDID_DEFAULT, esnd, "TSTERR", a);
+    return 0;
+}
 
-    pltf_file_close(l.f);
-    return r;
-}
\ No newline at end of file
+#if PLTF_DEV_ENV
+void app_atlas_export(const char *path)
+{
+    // read only sprites, too large ones stay on their own
+    i32 IDs[ARRLEN(app_sprites)];
+    for (i32 n = 0; n < ARRLEN(app_sprites); n++) {
+        IDs[n] = app_sprites[n].ID;
+    }
+
+    i32 n = assets_atlas_pack(IDs, ARRLEN(IDs), app_allocator());
+    pltf_log("ATLAS: %i of %i sprites packed\n", n, ARRLEN(IDs));
+    if (assets_atlas_export(path)) {
+        pltf_log("ATLAS: export failed\n");
+    }
+}
+#endif
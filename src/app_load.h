@@ -8,5 +8,10 @@
 #include "app.h"
 
 i32 app_load_assets();
+#if PLTF_DEV_ENV
+// packs the loaded sprites into atlas pages and writes them for the wad
+// packer, printing the lines for its list
+void app_atlas_export(const char *path);
+#endif
 
 #endif
\ No newline at end of file
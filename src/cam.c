@@ -16,8 +16,12 @@
 #define CAM_HERO_Y_TOP            (CAM_HERO_Y_BOT - 74) // tune for jump height
 #define CAM_OFFS_Q8_TOP           ((-120 + CAM_HERO_Y_TOP) * 256)
 #define CAM_OFFS_Q8_BOT           ((-120 + CAM_HERO_Y_BOT) * 256)
+#define CAM_SETTLE_TICKS          128 // ticks for the camera to converge
 
 static v2_i32 cam_constrain_to_room(g_s *g, v2_i32 p_center);
+static i32    cam_attract_target(g_s *g, v2_i32 pos_px, v2_i32 *attract);
+static void   cam_update_shake(cam_s *c);
+static void   cam_settle(g_s *g, cam_s *c);
 
 void cam_screenshake_xy(cam_s *c, i32 ticks, i32 str_x, i32 str_y)
 {
@@ -62,9 +66,111 @@ rec_i32 cam_rec_px(g_s *g, cam_s *c)
 
 void cam_init_level(g_s *g, cam_s *c)
 {
-    // update all the panning etc. which could happen
-    for (i32 n = 0; n < 128; n++) {
-        cam_update(g, c);
+#if PLTF_DEV_ENV
+    // check against updating all the panning etc. tick by tick;
+    // the shake draws random numbers, which mustn't differ from release
+    cam_s ci   = *c;
+    u32   seed = rng_seed_get();
+    for (i32 n = 0; n < CAM_SETTLE_TICKS; n++) {
+        cam_update(g, &ci);
+    }
+    rng_seed_set(seed);
+#endif
+    cam_settle(g, c);
+#if PLTF_DEV_ENV
+    cam_s  cs   = *c;
+    v2_i32 zero = {0};
+    ci.shake    = zero; // random
+    cs.shake    = zero;
+    v2_i32 pi   = cam_pos_px_top_left(g, &ci);
+    v2_i32 ps   = cam_pos_px_top_left(g, &cs);
+    if (1 < abs_i32(pi.x - ps.x) || 1 < abs_i32(pi.y - ps.y)) {
+        pltf_log("Cam settle: %i %i, iterated: %i %i\n", ps.x, ps.y, pi.x, pi.y);
+    }
+#endif
+}
+
+// closed form of CAM_SETTLE_TICKS calls to cam_update with the hero
+// standing still and no input
+static void cam_settle(g_s *g, cam_s *c)
+{
+    v2_i32 ppos = c->pos_q8;
+
+    switch (c->mode) {
+    case CAM_MODE_DIRECT: {
+        c->offs_x = sgn_i32(c->offs_x) *
+                    max_i32(abs_i32(c->offs_x) - CAM_SETTLE_TICKS, 0);
+        break;
+    }
+    case CAM_MODE_FOLLOW_HERO: {
+        obj_s *hero = obj_get_hero(g);
+        if (!hero) break;
+
+        v2_i32 herop       = obj_pos_bottom_center(hero);
+        i32    hero_bot_q8 = herop.y << 8;
+        i32    cam_y_min   = hero_bot_q8 - CAM_OFFS_Q8_BOT;
+        i32    cam_y_max   = hero_bot_q8 - CAM_OFFS_Q8_TOP;
+
+        // lands on the new base height, otherwise only kept in range
+        if (obj_grounded(g, hero) && 0 <= hero->v_q8.y) {
+            c->pos_q8.y = cam_y_min;
+        }
+        c->pos_q8.y    = clamp_i32(c->pos_q8.y, cam_y_min, cam_y_max);
+        c->can_align_y = c->pos_q8.y == cam_y_min || c->pos_q8.y == cam_y_max;
+        c->pos_q8.x    = herop.x << 8;
+
+        i32 offs_dir  = hero->facing + sgn_i32(hero->v_q8.x);
+        i32 offs_free = clamp_sym_i32(c->offs_x + offs_dir * CAM_SETTLE_TICKS,
+                                      CAM_FACE_OFFS_X);
+        i32 offs_attr = sgn_i32(c->offs_x) *
+                        max_i32(abs_i32(c->offs_x) - CAM_SETTLE_TICKS, 0);
+
+        v2_i32 pos_px = v2_shr(c->pos_q8, 8);
+        pos_px.x += offs_free;
+        v2_i32 attract   = {0};
+        i32    n_attract = cam_attract_target(g, cam_constrain_to_room(g, pos_px), &attract);
+        if (n_attract) { // the face offset decays while attracted
+            pos_px = v2_shr(c->pos_q8, 8);
+            pos_px.x += offs_attr;
+            attract   = (v2_i32){0};
+            n_attract = cam_attract_target(g, cam_constrain_to_room(g, pos_px), &attract);
+        }
+
+        // the attraction approaches its target exponentially in integer steps
+        if (n_attract) {
+            attract = v2_shl(attract, 8);
+            attract.x /= n_attract;
+            attract.y /= n_attract;
+            for (i32 n = 0; n < CAM_SETTLE_TICKS; n++) {
+                c->attract.x += ((attract.x - c->attract.x) * 16) / 256;
+                c->attract.y += ((attract.y - c->attract.y) * 16) / 256;
+                c->attract = v2_truncatel(c->attract, 16000);
+            }
+            c->offs_x      = offs_attr;
+            c->can_align_x = 0;
+        } else {
+            for (i32 n = 0; n < CAM_SETTLE_TICKS && (c->attract.x | c->attract.y); n++) {
+                c->attract.x = (c->attract.x * 253) / 256;
+                c->attract.y = (c->attract.y * 253) / 256;
+            }
+            c->offs_x      = offs_free;
+            c->can_align_x = abs_i32(c->offs_x) == CAM_FACE_OFFS_X;
+        }
+        break;
+    }
+    }
+
+    c->lookdown = 0;
+    if (c->shake_ticks) {
+        c->shake_ticks -= min_i32(c->shake_ticks, CAM_SETTLE_TICKS) - 1;
+        cam_update_shake(c);
+    }
+
+    if (c->locked_x) {
+        c->pos_q8.x = ppos.x;
+    }
+    if (c->locked_y) {
+        c->pos_q8.y = ppos.y;
     }
 }
 
@@ -126,28 +232,7 @@ void cam_update(g_s *g, cam_s *c)
         pos_px.x += c->offs_x;
         pos_px           = cam_constrain_to_room(g, pos_px);
         v2_i32 attract   = {0};
-        i32    n_attract = 0;
-
-        for (obj_each(g, o)) {
-            if (!o->cam_attract_r) continue;
-
-            v2_i32 pattr;
-            if (o->ID == OBJID_CAMATTRACTOR) {
-                pattr = camattractor_static_closest_pt(o, pos_px);
-            } else {
-                pattr = obj_pos_center(o);
-            }
-            v2_i32 attr = v2_sub(pattr, pos_px);
-            u32    ds   = pow2_u32(o->cam_attract_r);
-            u32    ls   = v2_lensq(attr);
-            if (ds <= ls) continue;
-
-            attr.x  = (attr.x * (i32)(ds - ls)) / (i32)ds;
-            attr.y  = (attr.y * (i32)(ds - ls)) / (i32)ds;
-            attract = v2_add(attract, attr);
-
-            n_attract++;
-        }
+        i32    n_attract = cam_attract_target(g, pos_px, &attract);
 
         if (n_attract) {
             attract = v2_shl(attract, 8);
@@ -176,11 +261,7 @@ void cam_update(g_s *g, cam_s *c)
     }
 
     if (c->shake_ticks) {
-        i32 shakex = (c->shake_str_x * c->shake_ticks + (c->shake_ticks_max >> 1)) / c->shake_ticks_max;
-        i32 shakey = (c->shake_str_y * c->shake_ticks + (c->shake_ticks_max >> 1)) / c->shake_ticks_max;
-        c->shake_ticks--;
-        c->shake.x = rngr_sym_i32(shakex);
-        c->shake.y = rngr_sym_i32(shakey);
+        cam_update_shake(c);
     }
 
     if (c->locked_x) {
@@ -191,6 +272,42 @@ void cam_update(g_s *g, cam_s *c)
     }
 }
 
+// sum of the pulls of all attractors in range, returns their number
+static i32 cam_attract_target(g_s *g, v2_i32 pos_px, v2_i32 *attract)
+{
+    i32 n_attract = 0;
+    for (obj_each(g, o)) {
+        if (!o->cam_attract_r) continue;
+
+        v2_i32 pattr;
+        if (o->ID == OBJID_CAMATTRACTOR) {
+            pattr = camattractor_static_closest_pt(o, pos_px);
+        } else {
+            pattr = obj_pos_center(o);
+        }
+        v2_i32 attr = v2_sub(pattr, pos_px);
+        u32    ds   = pow2_u32(o->cam_attract_r);
+        u32    ls   = v2_lensq(attr);
+        if (ds <= ls) continue;
+
+        attr.x   = (attr.x * (i32)(ds - ls)) / (i32)ds;
+        attr.y   = (attr.y * (i32)(ds - ls)) / (i32)ds;
+        *attract = v2_add(*attract, attr);
+
+        n_attract++;
+    }
+    return n_attract;
+}
+
+static void cam_update_shake(cam_s *c)
+{
+    i32 shakex = (c->shake_str_x * c->shake_ticks + (c->shake_ticks_max >> 1)) / c->shake_ticks_max;
+    i32 shakey = (c->shake_str_y * c->shake_ticks + (c->shake_ticks_max >> 1)) / c->shake_ticks_max;
+    c->shake_ticks--;
+    c->shake.x = rngr_sym_i32(shakex);
+    c->shake.y = rngr_sym_i32(shakey);
+}
+
 static v2_i32 cam_constrain_to_room(g_s *g, v2_i32 p_center)
 {
     v2_i32 v = {clamp_i32(p_center.x, CAM_WH, g->pixel_x - CAM_WH),
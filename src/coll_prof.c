@@ -0,0 +1,158 @@
+// =============================================================================
+// Copyright 2024, Lukas Wolski (the.strupf@proton.me). All rights reserved.
+// =============================================================================
+
+#include "coll_prof.h"
+#include "app.h"
+
+#if PLTF_DEV_ENV
+static const char *const coll_prof_name[NUM_COLL_PROF] = {
+    "BLOCKED",
+    "SOLID",
+    "ACTOR",
+    "STEP_SOLID"};
+
+b32 g_coll_prof_on;
+
+static struct {
+    coll_prof_tick_s cur;
+    coll_prof_tick_s worst[COLL_PROF_NUM_WORST]; // most expensive first
+    i32              n_worst;
+    u32              n_ticks;
+    u64              t_sum;
+    i32              depth;  // nesting of queries
+    i32              obj_ID; // object the queries belong to, -1 if none
+} g_coll_prof;
+
+static f32 coll_prof_ms(u64 t)
+{
+    return (f32)((f64)t * 1000.0 / (f64)SDL_GetPerformanceFrequency());
+}
+
+void coll_prof_toggle(void)
+{
+    if (g_coll_prof_on) {
+        coll_prof_report();
+        g_coll_prof_on = 0;
+        return;
+    }
+    mclr(&g_coll_prof, sizeof(g_coll_prof));
+    g_coll_prof.obj_ID = -1;
+    g_coll_prof_on     = 1;
+    pltf_log("COLL PROF: recording\n");
+}
+
+void coll_prof_tick_begin(void)
+{
+    if (!g_coll_prof_on) return;
+    mclr(&g_coll_prof.cur, sizeof(g_coll_prof.cur));
+    g_coll_prof.depth  = 0;
+    g_coll_prof.obj_ID = -1;
+}
+
+void coll_prof_tick_end(g_s *g)
+{
+    if (!g_coll_prof_on) return;
+    coll_prof_tick_s *c = &g_coll_prof.cur;
+    c->tick             = g->tick;
+    mcpy(c->mapname, g->mapname, sizeof(c->mapname));
+    g_coll_prof.n_ticks++;
+    g_coll_prof.t_sum += c->t;
+
+    // insert into the sorted list of worst ticks
+    i32 n = g_coll_prof.n_worst;
+    if (n == COLL_PROF_NUM_WORST) {
+        if (c->t <= g_coll_prof.worst[n - 1].t) return;
+        n--;
+    } else {
+        g_coll_prof.n_worst++;
+    }
+    for (; 0 < n && g_coll_prof.worst[n - 1].t < c->t; n--) {
+        g_coll_prof.worst[n] = g_coll_prof.worst[n - 1];
+    }
+    g_coll_prof.worst[n] = *c;
+}
+
+i32 coll_prof_obj_push(obj_s *o)
+{
+    i32 ID = g_coll_prof.obj_ID;
+    if (ID < 0) {
+        g_coll_prof.obj_ID = o->ID;
+    }
+    return ID;
+}
+
+void coll_prof_obj_pop(i32 ID)
+{
+    g_coll_prof.obj_ID = ID;
+}
+
+u64 coll_prof_t0(void)
+{
+    g_coll_prof.depth++;
+    u64 t = (u64)SDL_GetPerformanceCounter();
+    return (t ? t : 1); // 0 means not recording
+}
+
+void coll_prof_add(i32 type, obj_s *o, u64 t0)
+{
+    u64 t = (u64)SDL_GetPerformanceCounter() - t0;
+    i32 ID;
+    if (0 <= g_coll_prof.obj_ID) {
+        ID = g_coll_prof.obj_ID;
+    } else {
+        ID = o ? o->ID : NUM_OBJID;
+    }
+
+    coll_prof_tick_s *c = &g_coll_prof.cur;
+    c->n[type]++;
+    c->t_type[type] += t;
+    c->n_id[ID]++;
+    if (--g_coll_prof.depth == 0) {
+        c->t += t;
+        c->t_id[ID] += t;
+    }
+}
+
+void coll_prof_report(void)
+{
+    if (!g_coll_prof_on || !g_coll_prof.n_ticks) return;
+
+    pltf_log("COLL PROF: %u ticks, avg %.3f ms, worst %i:\n",
+             g_coll_prof.n_ticks,
+             coll_prof_ms(g_coll_prof.t_sum) / (f32)g_coll_prof.n_ticks,
+             g_coll_prof.n_worst);
+    for (i32 k = 0; k < g_coll_prof.n_worst; k++) {
+        coll_prof_tick_s *c = &g_coll_prof.worst[k];
+        pltf_log("#%i tick %u %s: %.3f ms\n",
+                 k + 1, c->tick, c->mapname, coll_prof_ms(c->t));
+        for (i32 i = 0; i < NUM_COLL_PROF; i++) {
+            pltf_log("  %-10s %6u %.3f ms\n",
+                     coll_prof_name[i], c->n[i], coll_prof_ms(c->t_type[i]));
+        }
+
+        // objects by time, then by number of queries
+        u8 done[COLL_PROF_NUM_ID] = {0};
+        for (i32 j = 0; j < 4; j++) {
+            i32 b = -1;
+            for (i32 i = 0; i < COLL_PROF_NUM_ID; i++) {
+                if (done[i] || !c->n_id[i]) continue;
+                if (b < 0 ||
+                    c->t_id[b] < c->t_id[i] ||
+                    (c->t_id[b] == c->t_id[i] && c->n_id[b] < c->n_id[i])) {
+                    b = i;
+                }
+            }
+            if (b < 0) break;
+            done[b] = 1;
+            if (b == NUM_OBJID) {
+                pltf_log("  no object  %6u %.3f ms\n",
+                         c->n_id[b], coll_prof_ms(c->t_id[b]));
+            } else {
+                pltf_log("  obj ID %3i %6u %.3f ms\n",
+                         b, c->n_id[b], coll_prof_ms(c->t_id[b]));
+            }
+        }
+    }
+}
+#endif
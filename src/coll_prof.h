@@ -0,0 +1,73 @@
+// =============================================================================
+// Copyright 2024, Lukas Wolski (the.strupf@proton.me). All rights reserved.
+// =============================================================================
+
+// Collision query statistics during development. While recording (dev key C)
+// every map_blocked*, tile_map_solid*, obj_step_actor and obj_step_solid call
+// is counted and timed per tick, by query type and by object ID. Queries are
+// attributed to the object being updated or moved at the time, or to the
+// object passed to the query outside of that.
+//
+// Times per type are inclusive: map_blocked* contains its tile_map_solid.
+// The tick and per object times only add up the outermost queries.
+//
+// The worst ticks are logged when recording stops or the app closes.
+// Compiles to nothing outside of the dev environment.
+
+#ifndef COLL_PROF_H
+#define COLL_PROF_H
+
+#include "gamedef.h"
+#include "objdef.h"
+
+enum {
+    COLL_PROF_MAP_BLOCKED, // map_blocked*
+    COLL_PROF_TILE_SOLID,  // tile_map_solid, tile_map_solid_pt
+    COLL_PROF_STEP_ACTOR,  // obj_step_actor
+    COLL_PROF_STEP_SOLID,  // obj_step_solid
+    //
+    NUM_COLL_PROF
+};
+
+#define COLL_PROF_NUM_WORST 8
+#define COLL_PROF_NUM_ID    (NUM_OBJID + 1) // last: no object
+
+typedef struct {
+    u32 tick;
+    u8  mapname[32];
+    u64 t; // performance counter, outermost queries
+    u32 n[NUM_COLL_PROF];
+    u64 t_type[NUM_COLL_PROF];
+    u32 n_id[COLL_PROF_NUM_ID];
+    u64 t_id[COLL_PROF_NUM_ID];
+} coll_prof_tick_s;
+
+#if PLTF_DEV_ENV
+extern b32 g_coll_prof_on;
+
+void coll_prof_toggle(void);
+void coll_prof_tick_begin(void);
+void coll_prof_tick_end(g_s *g);
+// attributes the following queries to o if no object is yet;
+// returns the object ID to restore
+i32  coll_prof_obj_push(obj_s *o);
+void coll_prof_obj_pop(i32 ID);
+u64  coll_prof_t0(void);
+void coll_prof_add(i32 type, obj_s *o, u64 t0);
+// logs the worst ticks recorded so far
+void coll_prof_report(void);
+
+#define coll_prof_begin()        (g_coll_prof_on ? coll_prof_t0() : 0)
+#define coll_prof_end(T, O, T0)  ((T0) ? coll_prof_add(T, O, T0) : (void)0)
+#else
+#define coll_prof_toggle()
+#define coll_prof_tick_begin()
+#define coll_prof_tick_end(G)
+#define coll_prof_obj_push(O)    0
+#define coll_prof_obj_pop(ID)    ((void)(ID))
+#define coll_prof_report()
+#define coll_prof_begin()        ((u64)0)
+#define coll_prof_end(T, O, T0)  ((void)(T0))
+#endif
+
+#endif
@@ -30,12 +30,18 @@ i32 assets_init()
 tex_s asset_tex(i32 ID)
 {
     assert(0 <= ID && ID < NUM_TEXID);
+    if (APP->res.tex_slot[ID]) { // managed
+        assets_res_use_tex(ID);
+    }
     return APP->assets.tex[ID].tex;
 }
 
 snd_s asset_snd(i32 ID)
 {
     assert(0 <= ID && ID < NUM_SNDID);
+    if (APP->res.snd_slot[ID]) { // managed
+        assets_res_use_snd(ID);
+    }
     return APP->assets.snd[ID].snd;
 }
 
@@ -111,7 +117,7 @@ i32 tex_from_wad(void *f, wad_el_s *wf, const void *name,
     i32 err_t = tex_create_ext(h.w, h.h, 1, a, o_t);
     if (err_t == 0) {
         usize size     = o_t->wword * o_t->h * sizeof(u32);
-        usize size_dec = lzss_decode_file(f, o_t->px);
+        usize size_dec = wad_rd_block(f, e, o_t->px);
         return (size == size_dec ? 0 : ASSET_ERR_RW);
     }
     return ASSET_ERR_ALLOC;
@@ -140,3 +146,147 @@ i32 snd_from_wad(void *f, wad_el_s *wf, const void *name,
     }
     return ASSET_ERR_ALLOC;
 }
+
+static tex_s assets_atlas_view(asset_atlas_s *at, asset_atlas_el_s el)
+{
+    tex_s page = at->pages[el.page - 1];
+    tex_s t    = page;
+    t.px       = &page.px[el.y * page.wword + ((el.x >> 5) << 1)];
+    t.w        = el.w;
+    t.h        = el.h;
+    return t;
+}
+
+i32 assets_atlas_pack(const i32 *IDs, i32 n, allocator_s a)
+{
+    asset_atlas_s *at = &APP->assets.atlas;
+
+    // sort by height, tallest first, to keep the shelves tight
+    spm_push();
+    i32 *ids = spm_alloct(i32, n);
+    i32  n_s = 0;
+    for (i32 i = 0; i < n; i++) {
+        tex_s t = asset_tex(IDs[i]);
+        if (!t.px || t.fmt != TEX_FMT_MASK ||
+            ASSETS_ATLAS_PAGE_W < t.w || ASSETS_ATLAS_PAGE_H < t.h ||
+            at->els[IDs[i]].page) continue;
+
+        i32 k = n_s++;
+        for (; 0 < k && asset_tex(ids[k - 1]).h < t.h; k--) {
+            ids[k] = ids[k - 1];
+        }
+        ids[k] = IDs[i];
+    }
+
+    // shelf packing, x advances in whole words
+    i32 n_packed = 0;
+    i32 x        = ASSETS_ATLAS_PAGE_W;
+    i32 y        = 0;
+    i32 shelf_h  = 0;
+    for (i32 i = 0; i < n_s; i++) {
+        i32   ID = ids[i];
+        tex_s t  = asset_tex(ID);
+        i32   wa = (t.w + 31) & ~31;
+
+        if (ASSETS_ATLAS_PAGE_W < x + wa) { // next shelf
+            x = 0;
+            y += shelf_h;
+            shelf_h = 0;
+        }
+        if (at->n_pages == 0 || ASSETS_ATLAS_PAGE_H < y + t.h) { // next page
+            if (ASSETS_ATLAS_NUM_PAGES <= at->n_pages) break;
+
+            tex_s *page = &at->pages[at->n_pages];
+            if (tex_create_ext(ASSETS_ATLAS_PAGE_W, ASSETS_ATLAS_PAGE_H,
+                               1, a, page) != 0) break;
+            mclr(page->px, sizeof(u32) * page->wword * page->h);
+            at->n_pages++;
+            x = 0, y = 0, shelf_h = 0;
+        }
+
+        asset_atlas_el_s el = {(u16)at->n_pages, (u16)x, (u16)y,
+                               (u16)t.w, (u16)t.h};
+        tex_s            v  = assets_atlas_view(at, el);
+        for (i32 r = 0; r < t.h; r++) {
+            mcpy(&v.px[r * v.wword], &t.px[r * t.wword], sizeof(u32) * t.wword);
+        }
+        at->els[ID] = el;
+        asset_tex_putID(ID, v);
+        x += wa;
+        shelf_h = max_i32(shelf_h, t.h);
+        n_packed++;
+    }
+    spm_pop();
+    return n_packed;
+}
+
+i32 assets_atlas_from_wad(void *f, wad_el_s *wf, allocator_s a)
+{
+    asset_atlas_s *at = &APP->assets.atlas;
+    u32            np = 0;
+
+    spm_push();
+    asset_atlas_el_s *els = spm_alloct(asset_atlas_el_s, NUM_TEXID);
+    wad_el_s         *e   = wad_seek_str(f, wf, "ATLASTBL");
+    i32               err = 0;
+    if (!e) {
+        err = ASSET_ERR_WAD_ENTRY;
+    } else if (!pltf_file_rs(f, &np, sizeof(u32)) ||
+               ASSETS_ATLAS_NUM_PAGES < np ||
+               !pltf_file_rs(f, els, sizeof(asset_atlas_el_s) * NUM_TEXID)) {
+        err = ASSET_ERR_RW;
+    }
+
+    for (u32 n = 0; n < np && !err; n++) {
+        char name[16] = "T_ATLAS";
+        str_append_i(name, (i32)n);
+        err = tex_from_wad(f, wf, name, a, &at->pages[n]);
+    }
+
+    if (!err) {
+        at->n_pages = np;
+        for (i32 ID = 0; ID < NUM_TEXID; ID++) {
+            if (!els[ID].page) continue;
+            at->els[ID] = els[ID];
+            asset_tex_putID(ID, assets_atlas_view(at, els[ID]));
+        }
+    }
+    spm_pop();
+    return err;
+}
+
+#if PLTF_DEV_ENV
+i32 assets_atlas_export(const char *path)
+{
+    asset_atlas_s *at = &APP->assets.atlas;
+
+    for (u32 n = 0; n < at->n_pages; n++) {
+        char fname[128];
+        str_cpy(fname, path);
+        str_append(fname, "_");
+        str_append_i(fname, (i32)n);
+        str_append(fname, ".tex");
+
+        tex_s        p = at->pages[n];
+        tex_header_s h = {(u32)p.w, (u32)p.h};
+        void        *f = pltf_file_open_w(fname);
+        if (!f) return ASSET_ERR_RW;
+        b32 w_ok = pltf_file_ws(f, &h, sizeof(tex_header_s));
+        w_ok &= pltf_file_ws(f, p.px, sizeof(u32) * p.wword * p.h);
+        pltf_file_close(f);
+        if (!w_ok) return ASSET_ERR_RW;
+        pltf_log("T_ATLAS%u lz4 %s 8\n", n, fname);
+    }
+
+    char fname[128];
+    str_cpy(fname, path);
+    str_append(fname, ".tbl");
+    void *f = pltf_file_open_w(fname);
+    if (!f) return ASSET_ERR_RW;
+    b32 w_ok = pltf_file_ws(f, &at->n_pages, sizeof(u32));
+    w_ok &= pltf_file_ws(f, at->els, sizeof(at->els));
+    pltf_file_close(f);
+    pltf_log("ATLASTBL raw %s\n", fname);
+    return (w_ok ? 0 : ASSET_ERR_RW);
+}
+#endif
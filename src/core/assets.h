@@ -151,10 +151,33 @@ typedef struct {
     fnt_s fnt;
 } asset_fnt_s;
 
+// Small read only sprites are packed into shared atlas pages. Packed
+// textures are 32 px aligned on their page so asset_tex() can return a view
+// (pointer into the page, page row stride) which works with all blitters.
+// Never pack textures which are drawn into or cleared as a whole.
+#define ASSETS_ATLAS_PAGE_W    256 // multiple of 32
+#define ASSETS_ATLAS_PAGE_H    256
+#define ASSETS_ATLAS_NUM_PAGES 4
+
+typedef struct {
+    u16 page; // 0 if not packed, otherwise page index + 1
+    u16 x;    // multiple of 32
+    u16 y;
+    u16 w;
+    u16 h;
+} asset_atlas_el_s;
+
 typedef struct {
-    asset_tex_s tex[NUM_TEXID];
-    asset_snd_s snd[NUM_SNDID];
-    asset_fnt_s fnt[NUM_FNTID];
+    u32              n_pages;
+    tex_s            pages[ASSETS_ATLAS_NUM_PAGES];
+    asset_atlas_el_s els[NUM_TEXID];
+} asset_atlas_s;
+
+typedef struct {
+    asset_tex_s   tex[NUM_TEXID];
+    asset_snd_s   snd[NUM_SNDID];
+    asset_fnt_s   fnt[NUM_FNTID];
+    asset_atlas_s atlas;
 } assets_s;
 
 i32      assets_init();
@@ -170,5 +193,14 @@ i32      tex_from_wad(void *f, wad_el_s *wf, const void *name,
                       allocator_s a, tex_s *o_t);
 i32      snd_from_wad(void *f, wad_el_s *wf, const void *name,
                       allocator_s a, snd_s *o_s);
+// packs loaded textures into atlas pages and redirects them to their page
+// returns number of packed textures
+i32      assets_atlas_pack(const i32 *IDs, i32 n, allocator_s a);
+// loads atlas pages (T_ATLAS0...) and the lookup table (ATLASTBL)
+i32      assets_atlas_from_wad(void *f, wad_el_s *wf, allocator_s a);
+#if PLTF_DEV_ENV
+// writes the packed pages and lookup table for the wad packer
+i32      assets_atlas_export(const char *path);
+#endif
 
 #endif
\ No newline at end of file
@@ -0,0 +1,373 @@
+// =============================================================================
+// Copyright 2024, Lukas Wolski (the.strupf@proton.me). All rights reserved.
+// =============================================================================
+
+#include "assets_jobs.h"
+#include "app.h"
+#include "util/str.h"
+
+typedef struct {
+    i32   err;
+    tex_s tex;
+    snd_s snd;
+    void *mem;
+    usize size;
+} asset_job_res_s;
+
+static asset_job_s *asset_jobs_head(asset_jobs_s *j);
+static asset_job_h  asset_jobs_push(asset_job_s *job);
+static void         asset_job_run(asset_jobs_s *j, asset_job_s *job, asset_job_res_s *res);
+static void         asset_job_commit(asset_jobs_s *j, asset_job_s *job, asset_job_res_s *res);
+static void         asset_jobs_file_close(asset_jobs_s *j);
+#if PLTF_THREADS
+static i32 asset_jobs_thread(void *ctx);
+#endif
+
+void asset_jobs_init()
+{
+    asset_jobs_s *j = &APP->jobs;
+    mclr(j, sizeof(asset_jobs_s));
+#if PLTF_THREADS
+    j->mutex  = pltf_mutex_create();
+    j->thread = j->mutex ? pltf_thread_create(asset_jobs_thread, j) : 0;
+    if (!j->thread) {
+        pltf_log("Asset worker unavailable, loading on main thread\n");
+    }
+#endif
+}
+
+void asset_jobs_destroy()
+{
+    asset_jobs_s *j = &APP->jobs;
+#if PLTF_THREADS
+    if (j->thread) {
+        pltf_mutex_lock(j->mutex);
+        j->quit = 1;
+        pltf_mutex_unlock(j->mutex);
+        pltf_thread_join(j->thread);
+        j->thread = 0;
+    }
+    if (j->mutex) {
+        pltf_mutex_destroy(j->mutex);
+        j->mutex = 0;
+    }
+#endif
+    asset_jobs_file_close(j);
+}
+
+// runs the oldest pending job on the calling thread
+// returns false if there was nothing to run
+static b32 asset_jobs_step(asset_jobs_s *j)
+{
+    asset_job_s *job = asset_jobs_head(j);
+    if (!job) return 0;
+    if (j->thread && job->type != ASSET_JOB_FUNC) return 0;
+
+    asset_job_res_s res = {0};
+    asset_job_run(j, job, &res);
+    asset_job_commit(j, job, &res);
+    return 1;
+}
+
+void asset_jobs_update()
+{
+    asset_jobs_s *j  = &APP->jobs;
+    f32           t0 = pltf_seconds();
+
+    while (asset_jobs_step(j)) {
+        if (ASSET_JOBS_TIMESLICE <= pltf_seconds() - t0) break;
+    }
+    if (!j->thread && !asset_jobs_busy()) {
+        asset_jobs_file_close(j);
+    }
+}
+
+b32 asset_jobs_busy()
+{
+    asset_jobs_s *j = &APP->jobs;
+    pltf_mutex_lock(j->mutex);
+    b32 busy = j->i_r < j->i_w;
+    pltf_mutex_unlock(j->mutex);
+    return busy;
+}
+
+i32 asset_jobs_err()
+{
+    asset_jobs_s *j = &APP->jobs;
+    pltf_mutex_lock(j->mutex);
+    i32 err = j->err;
+    pltf_mutex_unlock(j->mutex);
+    return err;
+}
+
+b32 asset_job_done(asset_job_h h)
+{
+    asset_jobs_s *j = &APP->jobs;
+    pltf_mutex_lock(j->mutex);
+    b32 done = h <= j->i_r;
+    pltf_mutex_unlock(j->mutex);
+    return done;
+}
+
+void asset_jobs_wait(asset_job_h h)
+{
+    asset_jobs_s *j = &APP->jobs;
+    pltf_mutex_lock(j->mutex);
+    b32 valid = h <= j->i_w;
+    pltf_mutex_unlock(j->mutex);
+    if (!valid) return;
+
+    while (!asset_job_done(h)) {
+        if (!asset_jobs_step(j)) {
+#if PLTF_THREADS
+            pltf_thread_sleep(1);
+#endif
+        }
+    }
+}
+
+void asset_jobs_wait_all()
+{
+    asset_jobs_s *j = &APP->jobs;
+    pltf_mutex_lock(j->mutex);
+    asset_job_h h = j->i_w;
+    pltf_mutex_unlock(j->mutex);
+    asset_jobs_wait(h);
+}
+
+asset_job_h asset_job_tex(i32 ID, wad_el_s *efrom, const char *name, allocator_s a)
+{
+    asset_job_s job = {0};
+    job.type        = ASSET_JOB_TEX;
+    job.ID          = ID;
+    job.efrom       = efrom;
+    job.a           = a;
+    str_cpys(job.name, sizeof(job.name), name);
+    return asset_jobs_push(&job);
+}
+
+asset_job_h asset_job_tex_opt(i32 ID, wad_el_s *efrom, const char *name, allocator_s a)
+{
+    asset_job_s job = {0};
+    job.type        = ASSET_JOB_TEX;
+    job.optional    = 1;
+    job.ID          = ID;
+    job.efrom       = efrom;
+    job.a           = a;
+    str_cpys(job.name, sizeof(job.name), name);
+    return asset_jobs_push(&job);
+}
+
+asset_job_h asset_job_snd(i32 ID, wad_el_s *efrom, const char *name, allocator_s a)
+{
+    asset_job_s job = {0};
+    job.type        = ASSET_JOB_SND;
+    job.ID          = ID;
+    job.efrom       = efrom;
+    job.a           = a;
+    str_cpys(job.name, sizeof(job.name), name);
+    return asset_jobs_push(&job);
+}
+
+asset_job_h asset_job_blob(wad_el_s *efrom, const char *name, allocator_s a,
+                           void **o_mem, usize *o_size)
+{
+    asset_job_s job = {0};
+    job.type        = ASSET_JOB_BLOB;
+    job.efrom       = efrom;
+    job.blob.a      = a;
+    job.blob.o_mem  = o_mem;
+    job.blob.o_size = o_size;
+    str_cpys(job.name, sizeof(job.name), name);
+    return asset_jobs_push(&job);
+}
+
+asset_job_h asset_job_blob_opt(wad_el_s *efrom, const char *name, allocator_s a,
+                               void **o_mem, usize *o_size)
+{
+    asset_job_s job = {0};
+    job.type        = ASSET_JOB_BLOB;
+    job.optional    = 1;
+    job.efrom       = efrom;
+    job.blob.a      = a;
+    job.blob.o_mem  = o_mem;
+    job.blob.o_size = o_size;
+    str_cpys(job.name, sizeof(job.name), name);
+    return asset_jobs_push(&job);
+}
+
+asset_job_h asset_job_func(void (*func)(void *ctx), void *ctx)
+{
+    asset_job_s job = {0};
+    job.type        = ASSET_JOB_FUNC;
+    job.func.func   = func;
+    job.func.ctx    = ctx;
+    return asset_jobs_push(&job);
+}
+
+static asset_job_s *asset_jobs_head(asset_jobs_s *j)
+{
+    pltf_mutex_lock(j->mutex);
+    asset_job_s *job = j->i_r < j->i_w
+                           ? &j->jobs[(j->i_r + 1) & (NUM_ASSET_JOBS - 1)]
+                           : 0;
+    pltf_mutex_unlock(j->mutex);
+    return job;
+}
+
+static asset_job_h asset_jobs_push(asset_job_s *job)
+{
+    asset_jobs_s *j = &APP->jobs;
+    pltf_mutex_lock(j->mutex);
+    u32 i_w = j->i_w;
+    pltf_mutex_unlock(j->mutex);
+
+    // queue full: wait for the slot to be freed up
+    if (NUM_ASSET_JOBS <= i_w) {
+        asset_jobs_wait(i_w + 1 - NUM_ASSET_JOBS);
+    }
+
+    asset_job_h h                     = i_w + 1;
+    j->jobs[h & (NUM_ASSET_JOBS - 1)] = *job;
+    pltf_mutex_lock(j->mutex);
+    j->i_w = h;
+    pltf_mutex_unlock(j->mutex);
+    return h;
+}
+
+static void *asset_jobs_file(asset_jobs_s *j, wad_el_s *efrom)
+{
+    if (!efrom) return 0;
+    if (j->f && j->f_fname == efrom->filename) return j->f;
+
+    asset_jobs_file_close(j);
+    j->f = pltf_file_open_r((const char *)efrom->filename);
+    if (j->f) {
+        j->f_fname = efrom->filename;
+    }
+    return j->f;
+}
+
+static void asset_jobs_file_close(asset_jobs_s *j)
+{
+    if (!j->f) return;
+    pltf_file_close(j->f);
+    j->f       = 0;
+    j->f_fname = 0;
+}
+
+static void asset_job_run(asset_jobs_s *j, asset_job_s *job, asset_job_res_s *res)
+{
+    switch (job->type) {
+    case ASSET_JOB_TEX: {
+        // already loaded as a part of an atlas page
+        if (APP->assets.atlas.els[job->ID].page) break;
+
+        void *f = asset_jobs_file(j, job->efrom);
+        if (!f) {
+            res->err = APP_ERR_WAD_OPEN;
+        } else if (tex_from_wad(f, job->efrom, job->name, job->a, &res->tex)) {
+            res->err = APP_ERR_ASSETS_DECODE;
+        }
+        break;
+    }
+    case ASSET_JOB_SND: {
+        void *f = asset_jobs_file(j, job->efrom);
+        if (!f) {
+            res->err = APP_ERR_WAD_OPEN;
+        } else if (snd_from_wad(f, job->efrom, job->name, job->a, &res->snd)) {
+            res->err = APP_ERR_ASSETS_DECODE;
+        }
+        break;
+    }
+    case ASSET_JOB_BLOB: {
+        void     *f = asset_jobs_file(j, job->efrom);
+        wad_el_s *e = f ? wad_seek_str(f, job->efrom, job->name) : 0;
+        if (!e) {
+            res->err = APP_ERR_ASSETS_WAD;
+            break;
+        }
+        allocator_s a    = job->blob.a;
+        usize       size = wad_rd_block_peek_size(f, e);
+        res->mem         = a.allocfunc(a.ctx, size, 8);
+        if (!res->mem) {
+            res->err = APP_ERR_MEM;
+            break;
+        }
+        res->size = wad_rd_block(f, e, res->mem);
+        res->err  = res->size == size ? 0 : APP_ERR_ASSETS_DECODE;
+        break;
+    }
+    case ASSET_JOB_FUNC: {
+        job->func.func(job->func.ctx);
+        break;
+    }
+    }
+
+    if (res->err && !job->optional) {
+        pltf_log("ERROR ASSET JOB %s: %i\n", job->name, res->err);
+    }
+}
+
+// publishes the result and marks the job as completed
+static void asset_job_commit(asset_jobs_s *j, asset_job_s *job, asset_job_res_s *res)
+{
+    pltf_mutex_lock(j->mutex);
+    if (!res->err) {
+        switch (job->type) {
+        case ASSET_JOB_TEX: {
+            if (!APP->assets.atlas.els[job->ID].page) {
+                APP->assets.tex[job->ID].tex = res->tex;
+            }
+            break;
+        }
+        case ASSET_JOB_SND: APP->assets.snd[job->ID].snd = res->snd; break;
+        case ASSET_JOB_BLOB: {
+            if (job->blob.o_mem) {
+                *job->blob.o_mem = res->mem;
+            }
+            if (job->blob.o_size) {
+                *job->blob.o_size = res->size;
+            }
+            break;
+        }
+        }
+    }
+    if (!job->optional) {
+        j->err |= res->err;
+    }
+    j->i_r++;
+    pltf_mutex_unlock(j->mutex);
+}
+
+#if PLTF_THREADS
+static i32 asset_jobs_thread(void *ctx)
+{
+    asset_jobs_s *j = (asset_jobs_s *)ctx;
+
+    while (1) {
+        pltf_mutex_lock(j->mutex);
+        b32          quit = j->quit;
+        asset_job_s *job  = 0;
+        if (j->i_r < j->i_w) {
+            job = &j->jobs[(j->i_r + 1) & (NUM_ASSET_JOBS - 1)];
+            if (job->type == ASSET_JOB_FUNC) {
+                job = 0; // main thread's turn
+            }
+        }
+        pltf_mutex_unlock(j->mutex);
+
+        if (quit) break;
+        if (job) {
+            asset_job_res_s res = {0};
+            asset_job_run(j, job, &res);
+            asset_job_commit(j, job, &res);
+        } else {
+            asset_jobs_file_close(j);
+            pltf_thread_sleep(1);
+        }
+    }
+    asset_jobs_file_close(j);
+    return 0;
+}
+#endif
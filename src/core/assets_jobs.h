@@ -0,0 +1,89 @@
+// =============================================================================
+// Copyright 2024, Lukas Wolski (the.strupf@proton.me). All rights reserved.
+// =============================================================================
+
+// Asset job queue: texture, sound and blob loads are queued and return a
+// handle which can be polled. On SDL a worker thread works through the queue,
+// on the Playdate the jobs are run in time sliced steps from asset_jobs_update.
+//
+// Jobs complete strictly in the order they were queued. FUNC jobs are always
+// run on the main thread once every job queued before them has completed,
+// which means the allocators passed to jobs are never used concurrently.
+
+#ifndef ASSETS_JOBS_H
+#define ASSETS_JOBS_H
+
+#include "assets.h"
+#include "pltf/pltf.h"
+#include "wad.h"
+
+#define NUM_ASSET_JOBS        64 // power of 2
+#define ASSET_JOBS_TIMESLICE  0.010f // seconds per tick spent on main thread jobs
+#define ASSET_JOB_H_NULL      0
+
+typedef u32 asset_job_h; // sequence number; done if <= number of completed jobs
+
+enum {
+    ASSET_JOB_TEX,
+    ASSET_JOB_SND,
+    ASSET_JOB_BLOB,
+    ASSET_JOB_FUNC,
+};
+
+typedef struct {
+    i32       type;
+    i32       ID;
+    b32       optional; // a failure doesn't count as a loading error
+    wad_el_s *efrom;
+    char      name[16];
+    union {
+        struct {
+            allocator_s a;
+            void      **o_mem;
+            usize      *o_size;
+        } blob;
+        allocator_s a;
+        struct {
+            void (*func)(void *ctx);
+            void *ctx;
+        } func;
+    };
+} asset_job_s;
+
+typedef struct {
+    asset_job_s jobs[NUM_ASSET_JOBS];
+    u32         i_w;  // number of queued jobs
+    u32         i_r;  // number of completed jobs
+    i32         err;  // accumulated errors of all jobs
+    b32         quit; // worker should exit
+    void       *mutex;
+    void       *thread;
+    void       *f;       // wad file kept open between consecutive jobs
+    const void *f_fname; // filename of the open wad file
+} asset_jobs_s;
+
+void        asset_jobs_init();
+void        asset_jobs_destroy();
+// runs main thread jobs (all jobs on the Playdate), call once per tick
+void        asset_jobs_update();
+b32         asset_jobs_busy();
+i32         asset_jobs_err();
+b32         asset_job_done(asset_job_h h);
+// blocks until the job has completed; runs main thread jobs while waiting
+void        asset_jobs_wait(asset_job_h h);
+void        asset_jobs_wait_all();
+//
+asset_job_h asset_job_tex(i32 ID, wad_el_s *efrom, const char *name, allocator_s a);
+// same as asset_job_tex, but a missing texture isn't reported by asset_jobs_err
+asset_job_h asset_job_tex_opt(i32 ID, wad_el_s *efrom, const char *name, allocator_s a);
+asset_job_h asset_job_snd(i32 ID, wad_el_s *efrom, const char *name, allocator_s a);
+// decodes a wad entry into memory from a; o_mem and o_size are written on completion
+asset_job_h asset_job_blob(wad_el_s *efrom, const char *name, allocator_s a,
+                           void **o_mem, usize *o_size);
+// same as asset_job_blob, but a failure isn't reported by asset_jobs_err;
+// o_mem stays untouched instead (e.g. for prefetching)
+asset_job_h asset_job_blob_opt(wad_el_s *efrom, const char *name, allocator_s a,
+                               void **o_mem, usize *o_size);
+asset_job_h asset_job_func(void (*func)(void *ctx), void *ctx);
+
+#endif
@@ -0,0 +1,227 @@
+// =============================================================================
+// Copyright 2024, Lukas Wolski (the.strupf@proton.me). All rights reserved.
+// =============================================================================
+
+#include "assets_res.h"
+#include "app.h"
+#include "util/str.h"
+
+static void  assets_res_add(i32 type, i32 ID, u8 *slot_of, wad_el_s *efrom, const char *name);
+static b32   assets_res_use(assets_res_s *r, i32 i);
+static b32   assets_res_load(assets_res_s *r, i32 i);
+static void  assets_res_free(assets_res_s *r, i32 i);
+static void *assets_res_alloc_ctx(void *ctx, usize s, usize alignment);
+
+i32 assets_res_init(usize budget)
+{
+    assets_res_s *r = &APP->res;
+    mclr(r, sizeof(assets_res_s));
+    r->budget = (u32)budget;
+    return 0;
+}
+
+void assets_res_tick()
+{
+    APP->res.tick++;
+}
+
+void assets_res_tex(i32 ID, wad_el_s *efrom, const char *name)
+{
+    assert(0 <= ID && ID < NUM_TEXID);
+    assets_res_add(ASSETS_RES_TEX, ID, APP->res.tex_slot, efrom, name);
+}
+
+void assets_res_snd(i32 ID, wad_el_s *efrom, const char *name)
+{
+    assert(0 <= ID && ID < NUM_SNDID);
+    assets_res_add(ASSETS_RES_SND, ID, APP->res.snd_slot, efrom, name);
+}
+
+b32 assets_res_use_tex(i32 ID)
+{
+    assets_res_s *r = &APP->res;
+    i32           i = (i32)r->tex_slot[ID] - 1;
+    return (i < 0 || assets_res_use(r, i));
+}
+
+b32 assets_res_use_snd(i32 ID)
+{
+    assets_res_s *r = &APP->res;
+    i32           i = (i32)r->snd_slot[ID] - 1;
+    return (i < 0 || assets_res_use(r, i));
+}
+
+// evicts everything which isn't in use right now, e.g. when changing areas
+void assets_res_evict_all()
+{
+    assets_res_s *r = &APP->res;
+    for (i32 k = r->n_blocks - 1; 0 <= k; k--) {
+        asset_res_s *s = &r->slots[r->blocks[k]];
+        if (s->tick_used + s->ticks_keep < r->tick) {
+            assets_res_free(r, r->blocks[k]);
+        }
+    }
+}
+
+u32 assets_res_used()
+{
+    return APP->res.used;
+}
+
+static void assets_res_add(i32 type, i32 ID, u8 *slot_of, wad_el_s *efrom, const char *name)
+{
+    assets_res_s *r = &APP->res;
+    if (slot_of[ID]) return;
+    if (ASSETS_RES_NUM_SLOTS <= r->n_slots) {
+        pltf_log("Residency: no slot left for %s\n", name);
+        return;
+    }
+    // the budget is only taken from the arena once something is managed
+    if (!r->mem) {
+        r->mem = (byte *)marena_alloc_aligned(&APP->ma, r->budget, 16);
+        if (!r->mem) {
+            pltf_log("Residency: no memory for the budget\n");
+            return;
+        }
+    }
+
+    i32          i = r->n_slots++;
+    asset_res_s *s = &r->slots[i];
+    mclr(s, sizeof(asset_res_s));
+    s->type  = (u8)type;
+    s->ID    = (u16)ID;
+    s->efrom = efrom;
+    str_cpys(s->name, sizeof(s->name), name);
+    slot_of[ID] = (u8)(i + 1);
+}
+
+static b32 assets_res_use(assets_res_s *r, i32 i)
+{
+    asset_res_s *s = &r->slots[i];
+    s->tick_used   = r->tick;
+    if (s->size) return 1;
+    if (s->failed) return 0;
+    return assets_res_load(r, i);
+}
+
+static b32 assets_res_load(assets_res_s *r, i32 i)
+{
+    asset_res_s *s   = &r->slots[i];
+    void        *f   = s->efrom ? pltf_file_open_r((const char *)s->efrom->filename) : 0;
+    i32          err = APP_ERR_WAD_OPEN;
+
+    r->oom = 0;
+    if (f) {
+        allocator_s a = {assets_res_alloc_ctx, s};
+        switch (s->type) {
+        case ASSETS_RES_TEX: {
+            tex_s t = {0};
+            err     = tex_from_wad(f, s->efrom, s->name, a, &t);
+            if (!err) {
+                APP->assets.tex[s->ID].tex = t;
+            }
+            break;
+        }
+        case ASSETS_RES_SND: {
+            snd_s n = {0};
+            err     = snd_from_wad(f, s->efrom, s->name, a, &n);
+            if (!err) {
+                APP->assets.snd[s->ID].snd = n;
+                // keep it as long as it may still be playing
+                u64 t         = (u64)n.num_samples * ASSETS_RES_SND_KEEP_Q * PLTF_UPS;
+                s->ticks_keep = (u32)(t / ASSETS_RES_SND_HZ) + PLTF_UPS;
+            }
+            break;
+        }
+        }
+        pltf_file_close(f);
+    }
+
+    if (err) {
+        pltf_log("Residency: can't load %s: %i\n", s->name, err);
+        s->failed = !r->oom; // retry later if the budget was just full
+        if (s->size) {
+            assets_res_free(r, i);
+        }
+        return 0;
+    }
+    return 1;
+}
+
+static void assets_res_free(assets_res_s *r, i32 i)
+{
+    asset_res_s *s = &r->slots[i];
+
+    for (i32 k = 0; k < r->n_blocks; k++) {
+        if (r->blocks[k] != i) continue;
+        for (i32 j = k + 1; j < r->n_blocks; j++) {
+            r->blocks[j - 1] = r->blocks[j];
+        }
+        r->n_blocks--;
+        break;
+    }
+    r->used -= s->size;
+    s->size = 0;
+
+    // drop the stale handle so nothing draws from freed memory
+    switch (s->type) {
+    case ASSETS_RES_TEX: mclr(&APP->assets.tex[s->ID].tex, sizeof(tex_s)); break;
+    case ASSETS_RES_SND: mclr(&APP->assets.snd[s->ID].snd, sizeof(snd_s)); break;
+    }
+}
+
+// first fit into the gaps between resident blocks;
+// evicts the least recently used assets until the block fits
+static void *assets_res_alloc_ctx(void *ctx, usize s, usize alignment)
+{
+    assets_res_s *r    = &APP->res;
+    asset_res_s  *el   = (asset_res_s *)ctx;
+    i32           i    = (i32)(el - r->slots);
+    usize         size = (s + 15) & ~(usize)15;
+    assert(el->size == 0);
+
+    while (1) {
+        usize p = 0;
+        for (i32 k = 0; k <= r->n_blocks; k++) {
+            usize pa  = (p + alignment - 1) & ~(alignment - 1);
+            usize end = r->budget;
+            if (k < r->n_blocks) {
+                end = r->slots[r->blocks[k]].offs;
+            }
+
+            if (pa + size <= end) {
+                for (i32 j = r->n_blocks; k < j; j--) {
+                    r->blocks[j] = r->blocks[j - 1];
+                }
+                r->blocks[k] = (u8)i;
+                r->n_blocks++;
+                el->offs = (u32)pa;
+                el->size = (u32)size;
+                r->used += (u32)size;
+                return (r->mem + pa);
+            }
+            if (k < r->n_blocks) {
+                asset_res_s *b = &r->slots[r->blocks[k]];
+                p              = b->offs + b->size;
+            }
+        }
+
+        i32 lru = -1;
+        for (i32 k = 0; k < r->n_blocks; k++) {
+            asset_res_s *b = &r->slots[r->blocks[k]];
+            if (r->tick <= b->tick_used + b->ticks_keep) continue; // in use
+
+            if (lru < 0 || b->tick_used < r->slots[lru].tick_used) {
+                lru = r->blocks[k];
+            }
+        }
+        if (lru < 0) { // everything resident is in use
+            r->oom = 1;
+            return 0;
+        }
+
+        pltf_log("Residency: evict %s\n", r->slots[lru].name);
+        assets_res_free(r, lru);
+        r->n_evicted++;
+    }
+}
@@ -0,0 +1,78 @@
+// =============================================================================
+// Copyright 2024, Lukas Wolski (the.strupf@proton.me). All rights reserved.
+// =============================================================================
+
+// Residency manager for assets which are only needed at times (e.g. area
+// backgrounds). Managed textures and sounds are loaded on first use from
+// asset_tex/asset_snd into a fixed budget. If the budget is exhausted the
+// least recently used assets are evicted.
+//
+// - a managed texture may be evicted once it wasn't used during the current
+//   tick: don't keep its tex_s around across ticks
+// - a managed sound is kept for a while after its last use so it can't be
+//   evicted while still playing
+
+#ifndef ASSETS_RES_H
+#define ASSETS_RES_H
+
+#include "assets.h"
+#include "wad.h"
+
+#ifdef PLTF_PD
+#define ASSETS_RES_BUDGET MKILOBYTE(1536)
+#else
+#define ASSETS_RES_BUDGET MMEGABYTE(2)
+#endif
+#define ASSETS_RES_NUM_SLOTS  128
+#define ASSETS_RES_SND_HZ     44100
+#define ASSETS_RES_SND_KEEP_Q 4 // sounds may be played pitched down to 1/4
+
+enum {
+    ASSETS_RES_TEX,
+    ASSETS_RES_SND,
+};
+
+typedef struct {
+    u8        type;
+    u8        failed; // don't retry a failed load every tick
+    u16       ID;
+    wad_el_s *efrom;
+    char      name[16];
+    u32       offs; // in budget memory
+    u32       size; // 0 if not resident
+    u32       tick_used;
+    u32       ticks_keep; // ticks to stay resident after last use
+} asset_res_s;
+
+typedef struct {
+    byte       *mem;
+    u32         budget;
+    u32         used;
+    u32         tick;
+    u32         n_evicted;
+    b32         oom; // last allocation didn't fit into the budget
+    i32         n_slots;
+    asset_res_s slots[ASSETS_RES_NUM_SLOTS];
+    // resident slots sorted by memory offset
+    i32         n_blocks;
+    u8          blocks[ASSETS_RES_NUM_SLOTS];
+    // slot for each managed asset + 1, 0 if not managed
+    u8          tex_slot[NUM_TEXID];
+    u8          snd_slot[NUM_SNDID];
+} assets_res_s;
+
+// the budget memory is reserved from the persistent arena when the first
+// asset is managed; call after the arena is ready
+i32  assets_res_init(usize budget);
+// call once per tick
+void assets_res_tick();
+// loads the asset from the wad on first use instead of up front
+void assets_res_tex(i32 ID, wad_el_s *efrom, const char *name);
+void assets_res_snd(i32 ID, wad_el_s *efrom, const char *name);
+// makes sure a managed asset is resident, returns false if it isn't
+b32  assets_res_use_tex(i32 ID);
+b32  assets_res_use_snd(i32 ID);
+void assets_res_evict_all();
+u32  assets_res_used();
+
+#endif
@@ -4,12 +4,17 @@
 
 #include "game.h"
 #include "app.h"
+#include "app_load.h"
 #include "render.h"
 
 void game_tick_gameplay(g_s *g);
 
 void game_init(g_s *g)
 {
+    marena_init(&g->memarena, g->mem, sizeof(g->mem));
+    if (map_cache_init(&g->mapcache, MAP_CACHE_BUDGET)) {
+        pltf_log("No memory for the map cache\n");
+    }
     g->cam.mode      = CAM_MODE_FOLLOW_HERO;
     g->obj_head_free = &g->obj_raw[0];
     for (i32 n = 0; n < NUM_OBJ; n++) {
@@ -59,6 +64,31 @@ void game_tick(g_s *g)
         cp->v_q8.y   = -300;
         cp->v_q8.x   = rngr_i32(-200, +200);
     }
+
+    // bake the autotiling of the current map for the wad
+    if (pltf_sdl_jkey(SDL_SCANCODE_B)) {
+        char fname[64];
+        str_cpy(fname, g->mapname);
+        str_append(fname, ".tiles");
+        map_bake_export(g, fname);
+    }
+    if (pltf_sdl_jkey(SDL_SCANCODE_R)) {
+        map_raycast_bench(g);
+    }
+    if (pltf_sdl_jkey(SDL_SCANCODE_V) && g->ghook.state) {
+        rope_verletsim_bench(g, &g->ghook.rope);
+    }
+    if (pltf_sdl_jkey(SDL_SCANCODE_C)) {
+        coll_prof_toggle();
+    }
+    // compare compression codecs on the loaded wads
+    if (pltf_sdl_jkey(SDL_SCANCODE_Z)) {
+        wad_bench_codecs();
+    }
+    // pack the sprites into atlas pages for the wad
+    if (pltf_sdl_jkey(SDL_SCANCODE_T)) {
+        app_atlas_export("atlas");
+    }
 #endif
 
     if (g->hero_hurt_lp_tick) {
@@ -135,12 +165,14 @@ void game_tick(g_s *g)
     }
 
     area_update(g, &g->area);
+    map_prefetch_update(g);
 }
 
 void game_tick_gameplay(g_s *g)
 {
     g->tick++;
     g->events_frame = 0;
+    obj_grid_tick(g);
 
     boss_update(g, &g->boss);
     areafx_snow_update(g, &g->area.fx.snow);
@@ -150,7 +182,10 @@ void game_tick_gameplay(g_s *g)
     obj_s *ohero = obj_get_hero(g);
     if (ohero) {
         inp_s heroinp = inp_cur();
+        i32   prof_ID = coll_prof_obj_push(ohero);
         hero_on_update(g, ohero, heroinp);
+        obj_grid_touch(g, ohero);
+        coll_prof_obj_pop(prof_ID);
     }
 
     objs_update(g);
@@ -9,16 +9,21 @@
 #include "boss/battleroom.h"
 #include "boss/boss.h"
 #include "cam.h"
+#include "coll_prof.h"
 #include "dialog.h"
 #include "gamedef.h"
 #include "gameover.h"
 #include "hero/grapplinghook.h"
 #include "hero/hero.h"
 #include "hero_powerup.h"
+#include "map_cache.h"
 #include "map_loader.h"
+#include "map_prefetch.h"
+#include "map_prof.h"
 #include "maptransition.h"
 #include "menu_screen.h"
 #include "obj.h"
+#include "obj_grid.h"
 #include "particle.h"
 #include "rope.h"
 #include "save.h"
@@ -33,6 +38,12 @@
 #define SAVE_TICKS          100
 #define SAVE_TICKS_FADE_OUT 80
 #define NUM_MAP_PINS        64
+// level arena memory for the tile layers of a map, enough for NUM_TILES;
+// smaller maps also fit their pixel collision bitmap, larger go without.
+// It is part of g_s all the time: a small map only clears and walks the
+// tiles it has, it doesn't give the rest of the memory back
+#define MAP_TILE_BYTES      (sizeof(tile_s) + sizeof(u16) * NUM_TILELAYER + sizeof(u8) * 2)
+#define MAP_TILES_MEM       (NUM_TILES * MAP_TILE_BYTES + 64) // + alignment
 
 enum {
     EVENT_HIT_ENEMY       = 1 << 0,
@@ -103,9 +114,11 @@ struct g_s {
     i32               tiles_y;
     i32               pixel_x;
     i32               pixel_y;
-    tile_s            tiles[NUM_TILES];
-    u16               rtiles[NUM_TILELAYER][NUM_TILES];
-    u8                fluid_streams[NUM_TILES];
+    tile_s           *tiles; // tiles_x * tiles_y, in memarena
+    u32              *tiles_px; // solid pixels, see tile_map_px_update, or null
+    u8               *tiles_dist; // see tile_map_dist_update
+    u16              *rtiles[NUM_TILELAYER];
+    u8               *fluid_streams;
     //
     obj_s            *obj_head_busy; // linked list
     obj_s            *obj_head_free; // linked list
@@ -117,6 +130,7 @@ struct g_s {
     u16               n_objrender;
     obj_s            *obj_render[NUM_OBJ]; // sorted render array
     obj_s             obj_raw[NUM_OBJ];
+    obj_grid_s        objgrid; // broadphase of obj_move
     //
     i32               n_foreground_props;
     foreground_prop_s foreground_props[NUM_FOREGROUND_PROPS];
@@ -137,9 +151,11 @@ struct g_s {
     hero_s            hero;
     particles_s       particles;
     ocean_s           ocean;
+    map_prefetch_s    prefetch;
+    map_cache_s       mapcache;
 
-    marena_s memarena;
-    byte     mem[MKILOBYTE(512)];
+    marena_s memarena; // reset on every map load
+    byte     mem[MKILOBYTE(512) + MAP_TILES_MEM];
 };
 
 void        game_init(g_s *g);
@@ -57,7 +57,7 @@ static void game_version_decode(u32 v, i32 *major, i32 *minor, i32 *patch)
 #define FILEPATH_FNT      "assets/fnt/"
 #define FILEPATH_DIALOG   "assets/dialog/"
 #define FILEEXTENSION_AUD ".aud"
-#define NUM_TILES         131072
+#define NUM_TILES         131072 // max tiles of a map, see MAP_TILES_MEM
 #define NUM_SAVEIDS       256
 #define NUM_MAP_NEIGHBORS 16
 
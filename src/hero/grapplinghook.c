@@ -39,12 +39,11 @@ void grapplinghook_create(g_s *g, grapplinghook_s *h, obj_s *ohero,
 
     // "hint" the direction to the verlet sim
     for (i32 n = 0; n < ROPE_VERLET_N; n++) {
-        rope_pt_s *pt = &r->ropept[n];
-
-        i32 k    = max_i32(0, ROPE_VERLET_N - 1 - n);
-        pt->p    = p_q8;
-        pt->pp.x = p_q8.x - (v.x * k) / ROPE_VERLET_N;
-        pt->pp.y = p_q8.y - (v.y * k) / ROPE_VERLET_N;
+        i32 k       = max_i32(0, ROPE_VERLET_N - 1 - n);
+        r->pt_x[n]  = p_q8.x;
+        r->pt_y[n]  = p_q8.y;
+        r->pt_px[n] = p_q8.x - (v.x * k) / ROPE_VERLET_N;
+        r->pt_py[n] = p_q8.y - (v.y * k) / ROPE_VERLET_N;
     }
 }
 
@@ -69,6 +68,70 @@ void grapplinghook_destroy(g_s *g, grapplinghook_s *h)
 
 bool32 grapplinghook_step(g_s *g, grapplinghook_s *h, i32 sx, i32 sy);
 
+// bresenham for a more linear movement
+static void grapplinghook_walk(g_s *g, grapplinghook_s *h, i32 dx, i32 dy)
+{
+    i32 px = +abs_i32(dx);
+    i32 py = -abs_i32(dy);
+    i32 sx = +sgn_i32(dx);
+    i32 sy = +sgn_i32(dy);
+    i32 e  = px + py;
+    i32 x  = 0;
+    i32 y  = 0;
+
+    while (x != dx || y != dy) {
+        i32 e2 = e << 1;
+        if (e2 >= py) {
+            if (!grapplinghook_step(g, h, sx, 0))
+                return;
+            e += py;
+            x += sx;
+        }
+        if (e2 <= px) {
+            if (!grapplinghook_step(g, h, 0, sy))
+                return;
+            e += px;
+            y += sy;
+        }
+    }
+}
+
+// raycasts the travel of this tick and jumps to the last free pixel before
+// a solid tile or object; only the rest is walked pixel by pixel. Hookable
+// objects aren't seen by the ray, so they make the hook walk all of it
+static void grapplinghook_fly(g_s *g, grapplinghook_s *h, i32 dx, i32 dy)
+{
+    v2_i32  p0 = h->p;
+    v2_i32  p1 = {p0.x + dx, p0.y + dy};
+    rec_i32 rb = {min_i32(p0.x, p1.x), min_i32(p0.y, p1.y),
+                  abs_i32(dx) + 1, abs_i32(dy) + 1};
+
+    bool32       hookable = 0;
+    obj_grid_q_s q        = obj_grid_query(g, rb, OBJ_FLAG_HOOKABLE);
+    for (i32 i = 0; i < q.n; i++) {
+        if (overlap_rec(rb, obj_aabb(q.o[i]))) {
+            hookable = 1;
+            break;
+        }
+    }
+    obj_grid_pop(g, q);
+
+    if (!hookable) {
+        v2_i32 hit;
+        i32    k = max_i32(abs_i32(dx), abs_i32(dy));
+        if (map_raycast(g, p0, p1, &hit)) {
+            k = max_i32(abs_i32(hit.x - p0.x), abs_i32(hit.y - p0.y)) - 1;
+        }
+
+        v2_i32 p = map_ray_pt(p0, p1, k);
+        if (!v2_eq(p, p0)) {
+            ropenode_move(g, &h->rope, h->rn, p.x - p0.x, p.y - p0.y);
+            h->p = p;
+        }
+    }
+    grapplinghook_walk(g, h, p1.x - h->p.x, p1.y - h->p.y);
+}
+
 void grapplinghook_update(g_s *g, grapplinghook_s *h)
 {
     if (h->state == GRAPPLINGHOOK_INACTICE) return;
@@ -88,30 +151,7 @@ void grapplinghook_update(g_s *g, grapplinghook_s *h)
         h->p_q8.x &= 0xFF;
         h->p_q8.y &= 0xFF;
 
-        i32 px = +abs_i32(dx);
-        i32 py = -abs_i32(dy);
-        i32 sx = +sgn_i32(dx);
-        i32 sy = +sgn_i32(dy);
-        i32 e  = px + py;
-        i32 x  = 0;
-        i32 y  = 0;
-
-        // bresenham for a more linear movement
-        while (x != dx || y != dy) {
-            i32 e2 = e << 1;
-            if (e2 >= py) {
-                if (!grapplinghook_step(g, h, sx, 0))
-                    break;
-                e += py;
-                x += sx;
-            }
-            if (e2 <= px) {
-                if (!grapplinghook_step(g, h, 0, sy))
-                    break;
-                e += px;
-                y += sy;
-            }
-        }
+        grapplinghook_fly(g, h, dx, dy);
         break;
     }
     case GRAPPLINGHOOK_HOOKED_SOLID: {
@@ -189,7 +229,7 @@ void grapplinghook_draw(g_s *g, grapplinghook_s *h, v2_i32 cam)
     u32              n_ropepts = 0;
 
     for (u32 k = 1; k < ROPE_VERLET_N; k++) {
-        v2_i32 p             = v2_shr(rope->ropept[k].p, 8);
+        v2_i32 p             = {rope->pt_x[k] >> 8, rope->pt_y[k] >> 8};
         ropepts[n_ropepts++] = v2_add(p, cam);
     }
 
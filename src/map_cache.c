@@ -0,0 +1,127 @@
+// =============================================================================
+// Copyright 2024, Lukas Wolski (the.strupf@proton.me). All rights reserved.
+// =============================================================================
+
+#include "map_cache.h"
+#include "app.h"
+
+static i32  map_cache_find(map_cache_s *c, u32 map_hash);
+static void map_cache_free(map_cache_s *c, i32 i);
+
+i32 map_cache_init(map_cache_s *c, usize budget)
+{
+    mclr(c, sizeof(map_cache_s));
+    c->mem = (byte *)marena_alloc_aligned(&APP->ma, budget, 16);
+    if (!c->mem) return APP_ERR_MEM;
+    c->budget = (u32)budget;
+    return 0;
+}
+
+void *map_cache_get(map_cache_s *c, u32 map_hash, usize *o_size)
+{
+    i32 i = map_cache_find(c, map_hash);
+    if (i < 0) return 0;
+
+    map_cache_el_s *el = &c->slots[i];
+    el->tick_used      = ++c->tick;
+    *o_size            = el->size;
+    return (c->mem + el->offs);
+}
+
+// first fit into the gaps between used blocks;
+// evicts the least recently used snapshots until the block fits
+void *map_cache_put(map_cache_s *c, u32 map_hash, usize size)
+{
+    map_cache_drop(c, map_hash);
+    if (!map_hash || c->budget < size) return 0;
+
+    usize s = (size + 15) & ~(usize)15;
+    while (1) {
+        i32 i_free = -1;
+        for (i32 i = 0; i < MAP_CACHE_NUM_SLOTS; i++) {
+            if (c->slots[i].map_hash == 0) {
+                i_free = i;
+                break;
+            }
+        }
+
+        usize p = 0;
+        for (i32 k = 0; 0 <= i_free && k <= c->n_blocks; k++) {
+            usize end = c->budget;
+            if (k < c->n_blocks) {
+                end = c->slots[c->blocks[k]].offs;
+            }
+
+            if (p + s <= end) {
+                for (i32 j = c->n_blocks; k < j; j--) {
+                    c->blocks[j] = c->blocks[j - 1];
+                }
+                c->blocks[k]       = (u8)i_free;
+                map_cache_el_s *el = &c->slots[i_free];
+                el->map_hash       = map_hash;
+                el->tick_used      = ++c->tick;
+                el->offs           = (u32)p;
+                el->size           = (u32)size;
+                c->n_blocks++;
+                return (c->mem + p);
+            }
+            if (k < c->n_blocks) {
+                map_cache_el_s *b = &c->slots[c->blocks[k]];
+                p                 = (b->offs + b->size + 15) & ~(usize)15;
+            }
+        }
+
+        i32 lru = -1;
+        for (i32 k = 0; k < c->n_blocks; k++) {
+            i32 i = c->blocks[k];
+            if (lru < 0 || c->slots[i].tick_used < c->slots[lru].tick_used) {
+                lru = i;
+            }
+        }
+        if (lru < 0) return 0;
+        map_cache_free(c, lru);
+    }
+}
+
+void map_cache_drop(map_cache_s *c, u32 map_hash)
+{
+    i32 i = map_cache_find(c, map_hash);
+    if (0 <= i) {
+        map_cache_free(c, i);
+    }
+}
+
+void map_cache_clr(map_cache_s *c)
+{
+    while (c->n_blocks) {
+        map_cache_free(c, c->blocks[0]);
+    }
+}
+
+b32 map_cache_has(map_cache_s *c, u32 map_hash)
+{
+    return (0 <= map_cache_find(c, map_hash));
+}
+
+static i32 map_cache_find(map_cache_s *c, u32 map_hash)
+{
+    if (map_hash == 0) return -1;
+
+    for (i32 i = 0; i < MAP_CACHE_NUM_SLOTS; i++) {
+        if (c->slots[i].map_hash == map_hash) return i;
+    }
+    return -1;
+}
+
+static void map_cache_free(map_cache_s *c, i32 i)
+{
+    for (i32 k = 0; k < c->n_blocks; k++) {
+        if (c->blocks[k] != i) continue;
+        for (i32 j = k + 1; j < c->n_blocks; j++) {
+            c->blocks[j - 1] = c->blocks[j];
+        }
+        c->n_blocks--;
+        break;
+    }
+    mclr(&c->slots[i], sizeof(map_cache_el_s));
+}
@@ -0,0 +1,61 @@
+// =============================================================================
+// Copyright 2024, Lukas Wolski (the.strupf@proton.me). All rights reserved.
+// =============================================================================
+
+// Snapshots of recently visited rooms. The loader stores what a room looks
+// like before its objects are spawned: the autotiled layers, grass, header
+// and object data. Re-entering a cached room copies them back instead of
+// reading, decoding and autotiling the wad entries again.
+//
+// Objects are always spawned from the object data under the current save
+// flags, the same way a room is loaded from the wad. A snapshot therefore
+// never holds state which save flags can change. The least recently used
+// snapshots are evicted once the budget is exhausted.
+//
+// Only the tile work is skipped: the area label, the area and weather
+// effects (they draw random numbers) and the objects are set up the same
+// way as for a room read from the wad.
+//
+// MAP_CACHE_BUDGET is reserved from the app arena in game_init, on top of
+// ASSETS_RES_BUDGET.
+
+#ifndef MAP_CACHE_H
+#define MAP_CACHE_H
+
+#include "gamedef.h"
+
+#ifdef PLTF_PD
+#define MAP_CACHE_BUDGET MKILOBYTE(512)
+#else
+#define MAP_CACHE_BUDGET MMEGABYTE(1)
+#endif
+#define MAP_CACHE_NUM_SLOTS 8
+
+typedef struct {
+    u32 map_hash; // 0 if empty
+    u32 tick_used;
+    u32 offs; // in budget memory
+    u32 size;
+} map_cache_el_s;
+
+typedef struct {
+    byte          *mem;
+    u32            budget;
+    u32            tick;
+    i32            n_blocks;
+    u8             blocks[MAP_CACHE_NUM_SLOTS]; // used slots sorted by offset
+    map_cache_el_s slots[MAP_CACHE_NUM_SLOTS];
+} map_cache_s;
+
+// reserves the budget memory, call after the persistent arena is ready
+i32   map_cache_init(map_cache_s *c, usize budget);
+// returns the snapshot of a room or null
+void *map_cache_get(map_cache_s *c, u32 map_hash, usize *o_size);
+// returns memory for the snapshot of a room or null if it doesn't fit,
+// replaces an older snapshot of the same room
+void *map_cache_put(map_cache_s *c, u32 map_hash, usize size);
+void  map_cache_drop(map_cache_s *c, u32 map_hash);
+void  map_cache_clr(map_cache_s *c);
+b32   map_cache_has(map_cache_s *c, u32 map_hash);
+
+#endif
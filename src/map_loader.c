@@ -25,6 +25,37 @@ typedef struct map_header_s {
     u16            n_obj;
 } map_header_s;
 
+// TILES entry: autotiling resolved offline by map_bake_export
+// followed by tile_s[w * h], the baked render layers u16[w * h] and
+// the grass tile positions u16[n_grass][2]
+typedef struct {
+    u16 version;
+    u16 n_grass;
+    u16 w;
+    u16 h;
+} map_baked_hd_s;
+
+static const u8 map_baked_layers[MAP_NUM_BAKED_LAYERS] = {TILELAYER_BG,
+                                                          TILELAYER_BG_TILE,
+                                                          TILELAYER_PROP_BG};
+
+static inline usize map_baked_size(usize n_tiles, usize n_grass)
+{
+    return (sizeof(map_baked_hd_s) +
+            sizeof(tile_s) * n_tiles +
+            sizeof(u16) * n_tiles * MAP_NUM_BAKED_LAYERS +
+            sizeof(u16) * 2 * n_grass);
+}
+
+// snapshot of a room in the map cache before its objects are spawned
+// followed by tile_s[w * h], grass_s[n_grass], the object data,
+// the render layers u16[NUM_TILELAYER][w * h] and the fluids u8[w * h]
+typedef struct {
+    map_header_s hd;
+    u32          n_grass;
+    u32          obj_size;
+} map_snapshot_s;
+
 typedef struct {
     u8 *t;
     i32 w;
@@ -89,6 +120,39 @@ typedef struct {
     u8 c[64];
 } map_string_s;
 
+typedef void (*map_obj_load_f)(g_s *g, map_obj_s *o);
+
+#define MAP_PROP_INDEX_NUM 32
+
+// hashed names of the properties of the object queried last:
+// loaders look up several properties of the same object in a row
+typedef struct {
+    void       *p; // first property, 0 if invalid
+    i32         n;
+    i32         n_rest; // properties beyond the index, searched linearly
+    u32         hash[MAP_PROP_INDEX_NUM];
+    map_prop_s *prop[MAP_PROP_INDEX_NUM];
+} map_prop_index_s;
+
+static map_prop_index_s g_map_prop_index;
+
+// case insensitive FNV-1a for object type and property names
+static u32 map_name_hash(const void *name)
+{
+    const u8 *s = (const u8 *)name;
+    u32       h = 2166136261U;
+    for (i32 n = 0; s[n] != '\0'; n++) {
+        h ^= (u32)char_lower(s[n]);
+        h *= 16777619U;
+    }
+    return h;
+}
+
+typedef struct {
+    const char    *name;
+    map_obj_load_f load;
+} map_obj_type_s;
+
 enum {
     TILE_FLIP_DIA = 1 << 0,
     TILE_FLIP_Y   = 1 << 1,
@@ -109,6 +173,9 @@ static void             map_at_terrain(g_s *g, tilelayer_u16 tiles, i32 x, i32 y
 static map_prop_s      *map_prop_get(map_properties_s p, const char *name);
 static map_properties_s map_obj_properties(map_obj_s *mo);
 static void             map_obj_parse(g_s *g, map_obj_s *o);
+static void             map_world_index(map_world_s *world);
+static void             map_world_cells(map_world_s *world, rec_i32 r,
+                                        i32 *cx1, i32 *cy1, i32 *cx2, i32 *cy2);
 //
 static bool32           at_types_blending(i32 a, i32 b);
 
@@ -119,117 +186,212 @@ static f32    map_prop_f32(map_properties_s p, const char *name);
 static bool32 map_prop_bool(map_properties_s p, const char *name);
 static v2_i16 map_prop_pt(map_properties_s p, const char *name);
 
-void loader_load_terrain(g_s *g, void *f, wad_el_s *wad_el, i32 w, i32 h);
-void loader_load_bgauto(g_s *g, void *f, wad_el_s *wad_el, i32 w, i32 h);
-void loader_load_bg(g_s *g, void *f, wad_el_s *wad_el, i32 w, i32 h);
+void loader_load_terrain(g_s *g, u16 *tmem, i32 w, i32 h);
+void loader_load_bgauto(g_s *g, u8 *tmem, i32 w, i32 h);
+void loader_load_bg(g_s *g, u16 *tmem, i32 w, i32 h);
 
-static void map_obj_parse(g_s *g, map_obj_s *o)
+static void  map_snapshot_store(g_s *g, map_header_s *hd, void *objmem, usize obj_size);
+static byte *map_snapshot_restore(g_s *g, map_snapshot_s *snap);
+
+// prefetched layer if available, otherwise decoded from the file into spm
+static void *map_layer_rd(void *f, wad_el_s *wad_el, map_prefetch_buf_s *pf, i32 i,
+                          usize *o_size)
 {
-    if (0) {
-    } else if (str_eq_nc(o->name, "Coin")) {
-        coin_load(g, o);
-    } else if (str_eq_nc(o->name, "Dummysolid")) {
-        dummysolid_load(g, o);
-    } else if (str_eq_nc(o->name, "Rotor")) {
-        rotor_load(g, o);
-    } else if (str_eq_nc(o->name, "Savepoint")) {
-        savepoint_load(g, o);
-    } else if (str_eq_nc(o->name, "Spiderboss")) {
-        spiderboss_load(g, o);
-    } else if (str_eq_nc(o->name, "Door")) {
-        door_load(g, o);
-    } else if (str_eq_nc(o->name, "Watercol")) {
-        watercol_load(g, o);
-    } else if (str_eq_nc(o->name, "Trampoline")) {
-        trampoline_load(g, o);
-    } else if (str_eq_nc(o->name, "Windarea")) {
-        windarea_load(g, o);
-    } else if (str_eq_nc(o->name, "Waterleaf")) {
-        waterleaf_load(g, o);
-    } else if (str_eq_nc(o->name, "Chest")) {
-        chest_load(g, o);
-    } else if (str_eq_nc(o->name, "Fallingblock")) {
-        fallingblock_load(g, o);
-    } else if (str_eq_nc(o->name, "Light")) {
-        light_load(g, o);
-    } else if (str_eq_nc(o->name, "Stompfloor")) {
-        stompable_block_load(g, o);
-    } else if (str_eq_nc(o->name, "Staminarestorer")) {
-        staminarestorer_load(g, o);
-    } else if (str_eq_nc(o->name, "Flyblob")) {
-        flyblob_load(g, o);
-    } else if (str_eq_nc(o->name, "Switch")) {
-        switch_load(g, o);
-    } else if (str_eq_nc(o->name, "Budplant")) {
-        budplant_load(g, o);
-    } else if (str_eq_nc(o->name, "Steamplatform")) {
-        steam_platform_load(g, o);
-    } else if (str_eq_nc(o->name, "Wallworm")) {
-        wallworm_load(g, o);
-    } else if (str_eq_nc(o->name, "Hookplant")) {
-        hookplant_load(g, o);
-    } else if (str_eq_nc(o->name, "Hero_Powerup")) {
-        hero_powerup_obj_load(g, o);
-    } else if (str_eq_nc(o->name, "NPC")) {
-        npc_load(g, o);
-    } else if (str_eq_nc(o->name, "Floater")) {
-        floater_load(g, o);
-    } else if (str_eq_nc(o->name, "Crawler")) {
-        crawler_load(g, o);
-    } else if (str_eq_nc(o->name, "Caterpillar")) {
-        crawler_caterpillar_load(g, o);
-    } else if (str_eq_nc(o->name, "Pushblock")) {
-        pushblock_load(g, o);
-    } else if (str_eq_nc(o->name, "Sign")) {
-        sign_load(g, o);
-    } else if (str_eq_nc(o->name, "Shroomy")) {
-        shroomy_load(g, o);
-    } else if (str_eq_nc(o->name, "Toggleblock")) {
-        toggleblock_load(g, o);
-    } else if (str_eq_nc(o->name, "Moving_Plat")) {
-        movingplatform_load(g, o);
-    } else if (str_contains(o->name, "Spikes_")) {
-        spikes_load(g, o);
-    } else if (str_eq_nc(o->name, "Crumbleblock")) {
-        crumbleblock_load(g, o);
-    } else if (str_eq_nc(o->name, "Teleport")) {
-        teleport_load(g, o);
-    } else if (str_eq_nc(o->name, "Stalactite")) {
-        stalactite_load(g, o);
-    } else if (str_eq_nc(o->name, "Walker")) {
-        walker_load(g, o);
-    } else if (str_eq_nc(o->name, "Flyer")) {
-        flyer_load(g, o);
-    } else if (str_eq_nc(o->name, "Clockpulse")) {
-        clockpulse_load(g, o);
-    } else if (str_eq_nc(o->name, "Triggerarea")) {
-        triggerarea_load(g, o);
-    } else if (str_eq_nc(o->name, "Hooklever")) {
-        hooklever_load(g, o);
-    } else if (str_eq_nc(o->name, "Cam_Attractor")) {
-        camattractor_static_load(g, o);
-    } else if (str_eq_nc(o->name, "Cam")) {
-        cam_s *cam    = &g->cam;
-        cam->locked_x = map_obj_bool(o, "Locked_X");
-        cam->locked_y = map_obj_bool(o, "Locked_Y");
-        if (cam->locked_x) {
-            cam->pos_q8.x = (o->x + PLTF_DISPLAY_W / 2) << 8;
-        }
-        if (cam->locked_y) {
-            cam->pos_q8.y = (o->y + PLTF_DISPLAY_H / 2) << 8;
+    *o_size = 0;
+    if (pf && pf->layer[i]) {
+        *o_size = pf->layer_size[i];
+        return pf->layer[i];
+    }
+
+    wad_el_s *e = map_layer_find(wad_el, map_layer_name[i]);
+    if (!e) return 0;
+    pltf_file_seek_set(f, e->offs);
+
+    void *dst = spm_alloc(wad_rd_block_peek_size(f, e));
+    *o_size   = wad_rd_block(f, e, dst);
+    map_prof_bytes(*o_size);
+    return dst;
+}
+
+static void map_tiles_clr(g_s *g)
+{
+    usize n = (usize)g->tiles_x * (usize)g->tiles_y;
+    mclr(g->tiles, sizeof(tile_s) * n);
+    for (i32 i = 0; i < NUM_TILELAYER; i++) {
+        mclr(g->rtiles[i], sizeof(u16) * n);
+    }
+    mclr(g->fluid_streams, n);
+    mclr(g->tiles_dist, n);
+    if (g->tiles_px) {
+        mclr(g->tiles_px, tile_map_px_size(g->tiles_x, g->tiles_y));
+    }
+}
+
+// allocates cleared tile layers for a map of w * h tiles from the level arena
+// call after the arena was reset, returns false if it doesn't fit
+static b32 map_tiles_alloc(g_s *g, i32 w, i32 h)
+{
+    usize n  = (usize)w * (usize)h;
+    g->tiles = (tile_s *)game_alloc(g, sizeof(tile_s) * n, 4);
+    for (i32 i = 0; i < NUM_TILELAYER; i++) {
+        g->rtiles[i] = (u16 *)game_alloc(g, sizeof(u16) * n, 2);
+    }
+    g->fluid_streams = (u8 *)game_alloc(g, n, 1);
+    g->tiles_dist    = (u8 *)game_alloc(g, n, 1);
+    usize n_px       = tile_map_px_size(w, h);
+    b32   px_fits    = n * MAP_TILE_BYTES + n_px <= NUM_TILES * MAP_TILE_BYTES;
+    g->tiles_px      = px_fits ? (u32 *)game_alloc(g, n_px, 4) : 0;
+    if (!g->tiles || !g->rtiles[NUM_TILELAYER - 1] || !g->fluid_streams ||
+        !g->tiles_dist) {
+        g->tiles_x = 0;
+        g->tiles_y = 0;
+        return 0;
+    }
+    map_tiles_clr(g);
+    return 1;
+}
+
+// copies the autotiled layers of a baked map
+// returns false if the map isn't baked or was baked by another version
+static b32 map_load_baked(g_s *g, void *p, usize size, i32 w, i32 h)
+{
+    map_baked_hd_s *hd = (map_baked_hd_s *)p;
+    if (!hd || size < sizeof(map_baked_hd_s)) return 0;
+    if (hd->version != MAP_BAKED_VERSION || hd->w != w || hd->h != h) return 0;
+
+    usize n = (usize)w * (usize)h;
+    if (size < map_baked_size(n, hd->n_grass)) return 0;
+
+    byte *ptr = (byte *)(hd + 1);
+    mcpy(g->tiles, ptr, sizeof(tile_s) * n);
+    ptr += sizeof(tile_s) * n;
+    for (i32 i = 0; i < MAP_NUM_BAKED_LAYERS; i++) {
+        mcpy(g->rtiles[map_baked_layers[i]], ptr, sizeof(u16) * n);
+        ptr += sizeof(u16) * n;
+    }
+
+    u16 *grass = (u16 *)ptr;
+    for (i32 i = 0; i < hd->n_grass; i++) {
+        grass_put(g, grass[i * 2 + 0], grass[i * 2 + 1]);
+    }
+    return 1;
+}
+
+static void map_obj_cam_load(g_s *g, map_obj_s *o)
+{
+    cam_s *cam    = &g->cam;
+    cam->locked_x = map_obj_bool(o, "Locked_X");
+    cam->locked_y = map_obj_bool(o, "Locked_Y");
+    if (cam->locked_x) {
+        cam->pos_q8.x = (o->x + PLTF_DISPLAY_W / 2) << 8;
+    }
+    if (cam->locked_y) {
+        cam->pos_q8.y = (o->y + PLTF_DISPLAY_H / 2) << 8;
+    }
+}
+
+static void map_obj_water_load(g_s *g, map_obj_s *o)
+{
+    i32 x1 = max_i32((o->x) >> 4, 0);
+    i32 y1 = max_i32((o->y) >> 4, 0);
+    i32 x2 = min_i32((o->x + o->w - 1) >> 4, g->tiles_x - 1);
+    i32 y2 = min_i32((o->y + o->h - 1) >> 4, g->tiles_y - 1);
+
+    for (i32 y = y1; y <= y2; y++) {
+        for (i32 x = x1; x <= x2; x++) {
+            g->tiles[x + y * g->tiles_x].type |= TILE_WATER_MASK;
         }
-    } else if (str_eq_nc(o->name, "Water")) {
-        i32 x1 = (o->x) >> 4;
-        i32 y1 = (o->y) >> 4;
-        i32 x2 = (o->x + o->w - 1) >> 4;
-        i32 y2 = (o->y + o->h - 1) >> 4;
-
-        for (i32 y = y1; y <= y2; y++) {
-            for (i32 x = x1; x <= x2; x++) {
-                g->tiles[x + y * g->tiles_x].type |= TILE_WATER_MASK;
+    }
+}
+
+// map object types: add new types here
+// names are matched case insensitive
+static const map_obj_type_s g_map_obj_types[] = {
+    {"Coin", coin_load},
+    {"Dummysolid", dummysolid_load},
+    {"Rotor", rotor_load},
+    {"Savepoint", savepoint_load},
+    {"Spiderboss", spiderboss_load},
+    {"Door", door_load},
+    {"Watercol", watercol_load},
+    {"Trampoline", trampoline_load},
+    {"Windarea", windarea_load},
+    {"Waterleaf", waterleaf_load},
+    {"Chest", chest_load},
+    {"Fallingblock", fallingblock_load},
+    {"Light", light_load},
+    {"Stompfloor", stompable_block_load},
+    {"Staminarestorer", staminarestorer_load},
+    {"Flyblob", flyblob_load},
+    {"Switch", switch_load},
+    {"Budplant", budplant_load},
+    {"Steamplatform", steam_platform_load},
+    {"Wallworm", wallworm_load},
+    {"Hookplant", hookplant_load},
+    {"Hero_Powerup", hero_powerup_obj_load},
+    {"NPC", npc_load},
+    {"Floater", floater_load},
+    {"Crawler", crawler_load},
+    {"Caterpillar", crawler_caterpillar_load},
+    {"Pushblock", pushblock_load},
+    {"Sign", sign_load},
+    {"Shroomy", shroomy_load},
+    {"Toggleblock", toggleblock_load},
+    {"Moving_Plat", movingplatform_load},
+    {"Crumbleblock", crumbleblock_load},
+    {"Teleport", teleport_load},
+    {"Stalactite", stalactite_load},
+    {"Walker", walker_load},
+    {"Flyer", flyer_load},
+    {"Clockpulse", clockpulse_load},
+    {"Triggerarea", triggerarea_load},
+    {"Hooklever", hooklever_load},
+    {"Cam_Attractor", camattractor_static_load},
+    {"Cam", map_obj_cam_load},
+    {"Water", map_obj_water_load},
+};
+
+#define MAP_OBJ_TYPES_HASH 128 // power of 2, at least twice the number of types
+
+static_assert(ARRLEN(g_map_obj_types) * 2 <= MAP_OBJ_TYPES_HASH, "map obj types");
+
+// open addressing table: index into g_map_obj_types + 1, 0 if empty
+// built on first use
+static u8 g_map_obj_types_hash[MAP_OBJ_TYPES_HASH];
+
+static map_obj_load_f map_obj_type_load(const void *name)
+{
+    static b32 init;
+    if (!init) {
+        init = 1;
+        for (i32 i = 0; i < ARRLEN(g_map_obj_types); i++) {
+            u32 k = map_name_hash(g_map_obj_types[i].name);
+            while (g_map_obj_types_hash[k & (MAP_OBJ_TYPES_HASH - 1)]) {
+                k++;
             }
+            g_map_obj_types_hash[k & (MAP_OBJ_TYPES_HASH - 1)] = (u8)(i + 1);
         }
     }
+
+    u32 k = map_name_hash(name);
+    while (1) {
+        i32 i = g_map_obj_types_hash[k & (MAP_OBJ_TYPES_HASH - 1)];
+        if (i == 0) return 0;
+
+        const map_obj_type_s *t = &g_map_obj_types[i - 1];
+        if (str_eq_nc(t->name, name)) return t->load;
+        k++;
+    }
+}
+
+static void map_obj_parse(g_s *g, map_obj_s *o)
+{
+    map_obj_load_f load = map_obj_type_load(o->name);
+    if (load) {
+        load(g, o);
+    } else if (str_contains(o->name, "Spikes_")) {
+        spikes_load(g, o);
+    }
 }
 
 void game_load_map(g_s *g, u32 map_hash)
@@ -242,9 +404,6 @@ void game_load_map(g_s *g, u32 map_hash)
     }
     objs_cull_to_delete(g);
 
-    mclr_static_arr(g->tiles);
-    mclr_static_arr(g->rtiles);
-    mclr_static_arr(g->fluid_streams);
     mclr_static_arr(g->map_neighbors);
     mclr(&g->ghook, sizeof(g->ghook));
 
@@ -259,20 +418,28 @@ void game_load_map(g_s *g, u32 map_hash)
     g->coins_added_ticks  = 0;
     // g->areaname.fadeticks = 1;
 
+    map_prof_begin(map_hash);
     marena_reset(&g->memarena, 0);
+    g->map_hash = map_hash;
 
     // READ FILE ===============================================================
 
-    void     *f;
-    wad_el_s *wad_el;
-    if (!wad_open(map_hash, &f, &wad_el)) {
+    // rooms visited recently are restored from their snapshot
+    usize           size;
+    map_snapshot_s *snap   = (map_snapshot_s *)map_cache_get(&g->mapcache, map_hash, &size);
+    void           *f      = 0;
+    wad_el_s       *wad_el = 0;
+    if (!snap && !wad_open(map_hash, &f, &wad_el)) {
         pltf_log("Can't load map file! %u\n", map_hash);
         BAD_PATH
     }
+    map_prof_mark(MAP_PROF_WAD);
 
     spm_push();
-    map_header_s *hd = spm_alloct(map_header_s, 1);
-    pltf_file_r(f, hd, sizeof(map_header_s));
+    map_header_s *hd = snap ? &snap->hd : spm_alloct(map_header_s, 1);
+    if (!snap) {
+        pltf_file_r(f, hd, sizeof(map_header_s));
+    }
 
     const i32 w = hd->w;
     const i32 h = hd->h;
@@ -281,6 +448,11 @@ void game_load_map(g_s *g, u32 map_hash)
     g->pixel_x  = w << 4;
     g->pixel_y  = h << 4;
     assert((w * h) <= NUM_TILES);
+    if (!map_tiles_alloc(g, w, h)) {
+        pltf_log("Map too big for the level arena! %i x %i\n", w, h);
+        BAD_PATH
+    }
+    map_prof_mark(MAP_PROF_HEADER);
 
     // PROPERTIES ==============================================================
     // mcpy(g->areaname.label, hd.name, 32);
@@ -289,33 +461,199 @@ void game_load_map(g_s *g, u32 map_hash)
     mcpy(g->map_neighbors, hd->map_neighbors, sizeof(hd->map_neighbors));
 
     prerender_area_label(g);
+    map_prof_mark(MAP_PROF_AREA_LABEL);
     area_setup(g, &g->area, 0);
     areafx_snow_setup(g, &g->area.fx.snow);
     areafx_heat_setup(g, &g->area.fx.heat);
     areafx_rain_setup(g, &g->area.fx.rain);
+    map_prof_mark(MAP_PROF_AREA);
+
+    byte *objmem = 0;
+    if (snap) {
+        spm_push();
+        objmem = map_snapshot_restore(g, snap);
+        map_prof_mark(MAP_PROF_TILES);
+    } else {
+        // layers already decoded in the background are used as they are
+        map_prefetch_buf_s *pf = map_prefetch_take(g, map_hash);
+
+        spm_push();
+        void *baked = map_layer_rd(f, wad_el, pf, MAP_LAYER_TILES, &size);
+        if (!map_load_baked(g, baked, size, w, h)) { // autotile at load time
+            spm_pop();
+            spm_push();
+            loader_load_terrain(g, (u16 *)map_layer_rd(f, wad_el, pf, MAP_LAYER_TERRAIN, &size), w, h);
+            map_prof_mark(MAP_PROF_TERRAIN);
+            spm_pop();
+            spm_push();
+            loader_load_bgauto(g, (u8 *)map_layer_rd(f, wad_el, pf, MAP_LAYER_BGAUTO, &size), w, h);
+            map_prof_mark(MAP_PROF_BGAUTO);
+            spm_pop();
+            spm_push();
+            loader_load_bg(g, (u16 *)map_layer_rd(f, wad_el, pf, MAP_LAYER_BGTILES, &size), w, h);
+            map_prof_mark(MAP_PROF_BGTILES);
+        } else {
+            map_prof_mark(MAP_PROF_TILES);
+        }
+        spm_pop();
 
-    loader_load_terrain(g, f, wad_el, w, h);
-    loader_load_bgauto(g, f, wad_el, w, h);
-    loader_load_bg(g, f, wad_el, w, h);
-    wad_rd_str(f, wad_el, "FLUIDS", g->fluid_streams);
+        spm_push();
+        void *fluids = map_layer_rd(f, wad_el, pf, MAP_LAYER_FLUIDS, &size);
+        if (fluids) {
+            mcpy(g->fluid_streams, fluids, min_u32((u32)size, (u32)(w * h)));
+        }
+        map_prof_mark(MAP_PROF_FLUIDS);
+        spm_pop();
+
+        spm_push();
+        objmem = (byte *)map_layer_rd(f, wad_el, pf, MAP_LAYER_OBJS, &size);
+        map_snapshot_store(g, hd, objmem, objmem ? size : 0);
+        pltf_file_close(f);
+        if (pf) {
+            map_prefetch_release(pf);
+        }
+        map_prof_mark(MAP_PROF_OBJS_READ);
+    }
 
-    spm_push();
-    byte *objmem  = (byte *)wad_rd_spm_str(f, wad_el, "OBJS");
-    byte *obj_ptr = objmem;
+    tile_map_px_update(g, 0, 0, w, h);
+    tile_map_dist_update(g, 0, 0, w, h);
+    g_map_prop_index.p = 0; // object memory is reused between maps
+    byte *obj_ptr      = objmem;
     for (i32 n = 0; n < hd->n_obj; n++) {
         map_obj_s *o = (map_obj_s *)obj_ptr;
         map_obj_parse(g, o);
         obj_ptr += o->bytes;
     }
+    map_prof_mark(MAP_PROF_OBJS_PARSE);
+    spm_pop();
     spm_pop();
     pltf_sync_timestep();
 }
 
-void loader_load_terrain(g_s *g, void *f, wad_el_s *wad_el, i32 w, i32 h)
+static inline usize map_align4(usize s)
+{
+    return ((s + 3) & ~(usize)3);
+}
+
+static usize map_snapshot_size(usize n_tiles, usize n_grass, usize obj_size)
 {
+    return (sizeof(map_snapshot_s) +
+            sizeof(tile_s) * n_tiles +
+            sizeof(grass_s) * n_grass +
+            map_align4(obj_size) +
+            sizeof(u16) * n_tiles * NUM_TILELAYER +
+            n_tiles);
+}
+
+// stores the room as it is before its objects are spawned
+static void map_snapshot_store(g_s *g, map_header_s *hd, void *objmem, usize obj_size)
+{
+    usize           n    = (usize)g->tiles_x * (usize)g->tiles_y;
+    usize           size = map_snapshot_size(n, g->n_grass, obj_size);
+    map_snapshot_s *snap = (map_snapshot_s *)map_cache_put(&g->mapcache, g->map_hash, size);
+    if (!snap) return;
+
+    snap->hd       = *hd;
+    snap->n_grass  = g->n_grass;
+    snap->obj_size = (u32)obj_size;
+
+    byte *ptr = (byte *)(snap + 1);
+    mcpy(ptr, g->tiles, sizeof(tile_s) * n);
+    ptr += sizeof(tile_s) * n;
+    mcpy(ptr, g->grass, sizeof(grass_s) * g->n_grass);
+    ptr += sizeof(grass_s) * g->n_grass;
+    mcpy(ptr, objmem, obj_size);
+    ptr += map_align4(obj_size);
+    for (i32 i = 0; i < NUM_TILELAYER; i++) {
+        mcpy(ptr, g->rtiles[i], sizeof(u16) * n);
+        ptr += sizeof(u16) * n;
+    }
+    mcpy(ptr, g->fluid_streams, n);
+}
+
+// copies the room back, returns its object data
+static byte *map_snapshot_restore(g_s *g, map_snapshot_s *snap)
+{
+    usize n = (usize)g->tiles_x * (usize)g->tiles_y;
+
+    byte *ptr = (byte *)(snap + 1);
+    mcpy(g->tiles, ptr, sizeof(tile_s) * n);
+    ptr += sizeof(tile_s) * n;
+    mcpy(g->grass, ptr, sizeof(grass_s) * snap->n_grass);
+    g->n_grass = snap->n_grass;
+    ptr += sizeof(grass_s) * snap->n_grass;
+    byte *objmem = ptr;
+    ptr += map_align4(snap->obj_size);
+    for (i32 i = 0; i < NUM_TILELAYER; i++) {
+        mcpy(g->rtiles[i], ptr, sizeof(u16) * n);
+        ptr += sizeof(u16) * n;
+    }
+    mcpy(g->fluid_streams, ptr, n);
+    return objmem;
+}
+
+#if PLTF_DEV_ENV
+// runs the autotiler on the raw layers of the current map into its tile layers
+static b32 map_bake_autotile(g_s *g)
+{
+    void     *f;
+    wad_el_s *wad_el;
+    if (!wad_open(g->map_hash, &f, &wad_el)) return 0;
+
+    const i32 w = g->tiles_x;
+    const i32 h = g->tiles_y;
+    usize     size;
+
+    map_tiles_clr(g);
+    g->n_grass = 0;
     spm_push();
-    u16 *tmem = (u16 *)wad_rd_spm_str(f, wad_el, "TERRAIN");
+    loader_load_terrain(g, (u16 *)map_layer_rd(f, wad_el, 0, MAP_LAYER_TERRAIN, &size), w, h);
+    loader_load_bgauto(g, (u8 *)map_layer_rd(f, wad_el, 0, MAP_LAYER_BGAUTO, &size), w, h);
+    loader_load_bg(g, (u16 *)map_layer_rd(f, wad_el, 0, MAP_LAYER_BGTILES, &size), w, h);
+    spm_pop();
+    pltf_file_close(f);
+    return 1;
+}
 
+i32 map_bake_export(g_s *g, const char *path)
+{
+    // the map is reloaded after
+    if (!map_bake_autotile(g)) return 1;
+    map_cache_drop(&g->mapcache, g->map_hash);
+
+    spm_push();
+    const i32      w = g->tiles_x;
+    const i32      h = g->tiles_y;
+    usize          n = (usize)w * (usize)h;
+    map_baked_hd_s b = {MAP_BAKED_VERSION, (u16)g->n_grass, (u16)w, (u16)h};
+    u16           *grass = spm_alloct(u16, 2 * g->n_grass);
+    for (u32 i = 0; i < g->n_grass; i++) {
+        grass[i * 2 + 0] = (u16)(g->grass[i].pos.x >> 4);
+        grass[i * 2 + 1] = (u16)(g->grass[i].pos.y >> 4);
+    }
+
+    b32   w_ok = 0;
+    void *fw   = pltf_file_open_w(path);
+    if (fw) {
+        w_ok = pltf_file_ws(fw, &b, sizeof(b));
+        w_ok &= pltf_file_ws(fw, g->tiles, sizeof(tile_s) * n);
+        for (i32 i = 0; i < MAP_NUM_BAKED_LAYERS; i++) {
+            w_ok &= pltf_file_ws(fw, g->rtiles[map_baked_layers[i]], sizeof(u16) * n);
+        }
+        w_ok &= pltf_file_ws(fw, grass, sizeof(u16) * 2 * g->n_grass);
+        pltf_file_close(fw);
+    }
+    spm_pop();
+
+    game_load_map(g, g->map_hash);
+    if (!w_ok) return 1;
+    pltf_log("TILES lz4 %s\n", path);
+    return 0;
+}
+#endif
+
+void loader_load_terrain(g_s *g, u16 *tmem, i32 w, i32 h)
+{
     tilelayer_u16 layer = {tmem, w, h};
 
     for (i32 y = 0; y < h; y++) {
@@ -336,10 +674,14 @@ void loader_load_terrain(g_s *g, void *f, wad_el_s *wad_el, i32 w, i32 h)
                     ty = 18;
                 }
 
-                g->tiles[k].collision               = TILE_LADDER;
-                g->rtiles[TILELAYER_PROP_BG][k]     = tileID_prop(5, ty);
-                g->rtiles[TILELAYER_PROP_BG][k - 1] = tileID_prop(4, ty);
-                g->rtiles[TILELAYER_PROP_BG][k + 1] = tileID_prop(6, ty);
+                g->tiles[k].collision           = TILE_LADDER;
+                g->rtiles[TILELAYER_PROP_BG][k] = tileID_prop(5, ty);
+                if (0 < x) { // layers are sized to the map
+                    g->rtiles[TILELAYER_PROP_BG][k - 1] = tileID_prop(4, ty);
+                }
+                if (x < w - 1) {
+                    g->rtiles[TILELAYER_PROP_BG][k + 1] = tileID_prop(6, ty);
+                }
                 break;
             }
             case TILE_LADDER_ONE_WAY: {
@@ -356,13 +698,10 @@ void loader_load_terrain(g_s *g, void *f, wad_el_s *wad_el, i32 w, i32 h)
             }
         }
     }
-    spm_pop();
 }
 
-void loader_load_bgauto(g_s *g, void *f, wad_el_s *wad_el, i32 w, i32 h)
+void loader_load_bgauto(g_s *g, u8 *tmem, i32 w, i32 h)
 {
-    spm_push();
-    u8          *tmem  = (u8 *)wad_rd_spm_str(f, wad_el, "BGAUTO");
     tilelayer_u8 layer = {tmem, w, h};
 
     for (i32 y = 0; y < h; y++) {
@@ -370,14 +709,10 @@ void loader_load_bgauto(g_s *g, void *f, wad_el_s *wad_el, i32 w, i32 h)
             map_at_background(g, layer, x, y);
         }
     }
-    spm_pop();
 }
 
-void loader_load_bg(g_s *g, void *f, wad_el_s *wad_el, i32 w, i32 h)
+void loader_load_bg(g_s *g, u16 *tmem, i32 w, i32 h)
 {
-    spm_push();
-    u16 *tmem = (u16 *)wad_rd_spm_str(f, wad_el, "BGTILES");
-
     for (i32 y = 0; y < h; y++) {
         for (i32 x = 0; x < w; x++) {
             i32 i = x + y * w;
@@ -388,7 +723,6 @@ void loader_load_bg(g_s *g, void *f, wad_el_s *wad_el, i32 w, i32 h)
             g->rtiles[TILELAYER_BG_TILE][i] = tileID_deco(tx, ty);
         }
     }
-    spm_pop();
 }
 
 static bool32 autotile_bg_is(tilelayer_u8 tiles, i32 x, i32 y, i32 sx, i32 sy)
@@ -680,13 +1014,38 @@ static void map_at_terrain(g_s *g, tilelayer_u16 tiles, i32 x, i32 y)
 static map_prop_s *map_prop_get(map_properties_s p, const char *name)
 {
     if (!p.p) return 0;
-    char *ptr = (char *)p.p;
-    for (i32 n = 0; n < p.n; n++) {
-        map_prop_s *prop = (map_prop_s *)ptr;
-        if (str_eq_nc(prop->name, name)) {
-            return prop;
+
+    map_prop_index_s *pi  = &g_map_prop_index;
+    char             *ptr = (char *)p.p;
+    if (pi->p != p.p) {
+        pi->p      = p.p;
+        pi->n      = min_i32(p.n, MAP_PROP_INDEX_NUM);
+        pi->n_rest = p.n - pi->n;
+        for (i32 n = 0; n < pi->n; n++) {
+            map_prop_s *prop = (map_prop_s *)ptr;
+            pi->hash[n]      = map_name_hash(prop->name);
+            pi->prop[n]      = prop;
+            ptr += prop->bytes;
+        }
+    }
+
+    u32 h = map_name_hash(name);
+    for (i32 n = 0; n < pi->n; n++) {
+        if (pi->hash[n] == h && str_eq_nc(pi->prop[n]->name, name)) {
+            return pi->prop[n];
+        }
+    }
+
+    if (pi->n_rest) {
+        map_prop_s *last = pi->prop[pi->n - 1];
+        ptr              = (char *)last + last->bytes;
+        for (i32 n = 0; n < pi->n_rest; n++) {
+            map_prop_s *prop = (map_prop_s *)ptr;
+            if (str_eq_nc(prop->name, name)) {
+                return prop;
+            }
+            ptr += prop->bytes;
         }
-        ptr += prop->bytes;
     }
     pltf_log("No property: %s\n", name);
     return 0;
@@ -791,33 +1150,148 @@ void map_world_load(map_world_s *world, const char *worldfile)
     if (!world || !worldfile || worldfile[0] == '\0') return;
 
     FILEPATH_GEN(filepath, FILEPATH_MAP, worldfile);
+    mclr(world, sizeof(map_world_s));
     void *f = pltf_file_open_r(filepath);
-    pltf_file_r(f, world, sizeof(map_world_s));
+    if (!f) return;
+
+    // rooms follow the room count; only the used rooms are read
+    pltf_file_r(f, &world->n_rooms, sizeof(u32));
+    world->n_rooms = min_u32(world->n_rooms, NUM_WORLD_ROOMS);
+    pltf_file_r(f, world->rooms, sizeof(map_worldroom_s) * world->n_rooms);
     pltf_file_close(f);
+    map_world_index(world);
 }
 
 map_worldroom_s *map_world_overlapped_room(map_world_s *world, map_worldroom_s *cur, rec_i32 r)
 {
-    for (u32 i = 0; i < world->n_rooms; i++) {
-        map_worldroom_s *room = &world->rooms[i];
-        if (room == cur) continue;
-        rec_i32 rr = {room->x, room->y, room->w, room->h};
-        if (overlap_rec(rr, r))
-            return room;
+    if (world->grid_full) {
+        for (u32 i = 0; i < world->n_rooms; i++) {
+            map_worldroom_s *room = &world->rooms[i];
+            if (room == cur) continue;
+            rec_i32 rr = {room->x, room->y, room->w, room->h};
+            if (overlap_rec(rr, r))
+                return room;
+        }
+        return NULL;
     }
-    return NULL;
+    if (world->cell_w == 0) return NULL;
+
+    // lowest overlapping room index, same as scanning all rooms
+    i32 cx1, cy1, cx2, cy2;
+    i32 found = -1;
+    map_world_cells(world, r, &cx1, &cy1, &cx2, &cy2);
+    for (i32 cy = cy1; cy <= cy2; cy++) {
+        for (i32 cx = cx1; cx <= cx2; cx++) {
+            i32 c = cx + cy * MAP_WORLD_GRID;
+            for (i32 k = world->cell_beg[c]; k < world->cell_beg[c + 1]; k++) {
+                i32 i = world->cell_refs[k];
+                if (0 <= found && found <= i) continue;
+
+                map_worldroom_s *room = &world->rooms[i];
+                if (room == cur) continue;
+                rec_i32 rr = {room->x, room->y, room->w, room->h};
+                if (overlap_rec(rr, r)) {
+                    found = i;
+                }
+            }
+        }
+    }
+    return (0 <= found ? &world->rooms[found] : NULL);
 }
 
 map_worldroom_s *map_world_find_room(map_world_s *world, const char *mapfile)
 {
-    for (u32 i = 0; i < world->n_rooms; i++) {
-        map_worldroom_s *room = &world->rooms[i];
+    u32 k = wad_hash(mapfile);
+    for (i32 n = 0; n < MAP_WORLD_NAME_HASH; n++, k++) {
+        i32 i = world->name_hash[k & (MAP_WORLD_NAME_HASH - 1)];
+        if (i == 0) break;
+
+        map_worldroom_s *room = &world->rooms[i - 1];
         if (str_eq(room->filename, mapfile))
             return room;
     }
     return NULL;
 }
 
+static void map_world_cells(map_world_s *world, rec_i32 r,
+                            i32 *cx1, i32 *cy1, i32 *cx2, i32 *cy2)
+{
+    i32 x1 = (r.x - world->grid_x) / world->cell_w;
+    i32 y1 = (r.y - world->grid_y) / world->cell_h;
+    i32 x2 = (r.x + r.w - 1 - world->grid_x) / world->cell_w;
+    i32 y2 = (r.y + r.h - 1 - world->grid_y) / world->cell_h;
+    *cx1   = clamp_i32(x1, 0, MAP_WORLD_GRID - 1);
+    *cy1   = clamp_i32(y1, 0, MAP_WORLD_GRID - 1);
+    *cx2   = clamp_i32(max_i32(x1, x2), 0, MAP_WORLD_GRID - 1);
+    *cy2   = clamp_i32(max_i32(y1, y2), 0, MAP_WORLD_GRID - 1);
+}
+
+static void map_world_index(map_world_s *world)
+{
+    if (world->n_rooms == 0) return;
+
+    // bounds of all rooms
+    i32 x1 = I32_MAX;
+    i32 y1 = I32_MAX;
+    i32 x2 = I32_MIN;
+    i32 y2 = I32_MIN;
+    for (u32 i = 0; i < world->n_rooms; i++) {
+        map_worldroom_s *room = &world->rooms[i];
+        x1                    = min_i32(x1, room->x);
+        y1                    = min_i32(y1, room->y);
+        x2                    = max_i32(x2, room->x + room->w);
+        y2                    = max_i32(y2, room->y + room->h);
+    }
+    world->grid_x = x1;
+    world->grid_y = y1;
+    world->cell_w = max_i32((x2 - x1 + MAP_WORLD_GRID - 1) / MAP_WORLD_GRID, 1);
+    world->cell_h = max_i32((y2 - y1 + MAP_WORLD_GRID - 1) / MAP_WORLD_GRID, 1);
+
+    // count the rooms per cell, then fill the cells in room order
+    u16 n_refs[MAP_WORLD_GRID * MAP_WORLD_GRID] = {0};
+    i32 n_total                                  = 0;
+    for (i32 pass = 0; pass < 2; pass++) {
+        for (u32 i = 0; i < world->n_rooms; i++) {
+            map_worldroom_s *room = &world->rooms[i];
+            rec_i32          rr   = {room->x, room->y, room->w, room->h};
+            i32              cx1, cy1, cx2, cy2;
+            map_world_cells(world, rr, &cx1, &cy1, &cx2, &cy2);
+
+            for (i32 cy = cy1; cy <= cy2; cy++) {
+                for (i32 cx = cx1; cx <= cx2; cx++) {
+                    i32 c = cx + cy * MAP_WORLD_GRID;
+                    if (pass == 0) {
+                        n_refs[c]++;
+                        n_total++;
+                    } else {
+                        world->cell_refs[world->cell_beg[c] + n_refs[c]++] = (u16)i;
+                    }
+                }
+            }
+        }
+
+        if (pass == 0) {
+            if (MAP_WORLD_GRID_REFS < n_total) {
+                world->grid_full = 1;
+                pltf_log("World: too many room references, no grid\n");
+                break;
+            }
+            for (i32 c = 0; c < MAP_WORLD_GRID * MAP_WORLD_GRID; c++) {
+                world->cell_beg[c + 1] = world->cell_beg[c] + n_refs[c];
+                n_refs[c]              = 0;
+            }
+        }
+    }
+
+    for (u32 i = 0; i < world->n_rooms; i++) {
+        u32 k = wad_hash(world->rooms[i].filename);
+        while (world->name_hash[k & (MAP_WORLD_NAME_HASH - 1)]) {
+            k++;
+        }
+        world->name_hash[k & (MAP_WORLD_NAME_HASH - 1)] = (u16)(i + 1);
+    }
+}
+
 map_worldroom_s *map_worldroom_by_objID(map_world_s *world, u32 objID)
 {
     i32 i = (objID >> 8) - 1;
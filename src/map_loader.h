@@ -8,6 +8,10 @@
 #include "gamedef.h"
 #include "util/lzss.h"
 
+// maps with a TILES entry of another version are autotiled at load time
+#define MAP_BAKED_VERSION    1
+#define MAP_NUM_BAKED_LAYERS 3 // render layers resolved by the autotiler
+
 typedef struct {
     i32 ID; // 1...
     i32 x;
@@ -18,9 +22,23 @@ typedef struct {
     char filename[64];
 } map_worldroom_s;
 
+#define MAP_WORLD_GRID      16                    // cells per axis of the room grid
+#define MAP_WORLD_GRID_REFS (NUM_WORLD_ROOMS * 8) // room references in all cells
+#define MAP_WORLD_NAME_HASH (NUM_WORLD_ROOMS * 2) // power of 2
+
 typedef struct {
     u32             n_rooms;
     map_worldroom_s rooms[NUM_WORLD_ROOMS];
+    // index built by map_world_load: uniform grid over the bounds of all
+    // rooms and an open addressing table of the room filenames
+    i32             grid_x;
+    i32             grid_y;
+    i32             cell_w;    // 0 if no rooms
+    i32             cell_h;    //
+    b32             grid_full; // too many references: rooms are scanned
+    u16             cell_beg[MAP_WORLD_GRID * MAP_WORLD_GRID + 1];
+    u16             cell_refs[MAP_WORLD_GRID_REFS];
+    u16             name_hash[MAP_WORLD_NAME_HASH]; // room index + 1
 } map_world_s;
 
 typedef struct {
@@ -50,6 +68,11 @@ void  *map_obj_arr(map_obj_s *mo, const char *name, i32 *num);
 
 void             game_load_map(g_s *g, u32 map_hash);
 void             game_prepare_new_map(g_s *g);
+#if PLTF_DEV_ENV
+// autotiles the current map once and writes it as a TILES entry for the wad;
+// logs the matching wadpack list line, returns non-zero on error
+i32              map_bake_export(g_s *g, const char *path);
+#endif
 void             map_world_load(map_world_s *world, const char *mapfile);
 map_worldroom_s *map_world_overlapped_room(map_world_s *world, map_worldroom_s *cur, rec_i32 r);
 map_worldroom_s *map_world_find_room(map_world_s *world, const char *mapfile);
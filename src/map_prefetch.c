@@ -0,0 +1,179 @@
+// =============================================================================
+// Copyright 2024, Lukas Wolski (the.strupf@proton.me). All rights reserved.
+// =============================================================================
+
+#include "map_prefetch.h"
+#include "app.h"
+#include "game.h"
+
+const char *const map_layer_name[NUM_MAP_LAYERS] = {
+    "TERRAIN",
+    "BGAUTO",
+    "BGTILES",
+    "FLUIDS",
+    "OBJS",
+    "TILES"};
+
+static map_prefetch_buf_s *map_prefetch_find(map_prefetch_s *p, u32 map_hash);
+static b32                 map_layer_is_layer(u32 h);
+static void                map_prefetch_queue(map_prefetch_buf_s *b, u32 map_hash);
+static void               *map_prefetch_alloc(void *ctx, usize s, usize alignment);
+
+wad_el_s *map_layer_find(wad_el_s *wad_el, const char *name)
+{
+    if (!wad_el) return 0;
+    u32 h     = wad_hash(name);
+    i32 n_end = APP->wad.n_entries;
+    for (i32 n = (i32)(wad_el - APP->wad.entries) + 1; n < n_end; n++) {
+        wad_el_s *e = &APP->wad.entries[n];
+        if (e->filename != wad_el->filename || !map_layer_is_layer(e->hash)) {
+            break; // next map
+        }
+        if (e->hash == h) return e;
+    }
+    return 0;
+}
+
+static b32 map_layer_is_layer(u32 h)
+{
+    for (i32 i = 0; i < NUM_MAP_LAYERS; i++) {
+        if (h == wad_hash(map_layer_name[i])) return 1;
+    }
+    return 0;
+}
+
+// decoded size of the tile layers of a baked map (raw layers are smaller),
+// objects are not known up front
+static inline usize map_prefetch_est_size(map_neighbor_s *mn)
+{
+    usize n = (usize)(mn->w >> 4) * (usize)(mn->h >> 4);
+    return (n * (sizeof(tile_s) + sizeof(u16) * 3 + sizeof(u8)) + 64);
+}
+
+// distance in pixels between the hero and a neighboring room
+static i32 map_prefetch_dist(rec_i32 a, map_neighbor_s *mn)
+{
+    i32 dx = max_i32(mn->x - (a.x + a.w), a.x - (mn->x + mn->w));
+    i32 dy = max_i32(mn->y - (a.y + a.h), a.y - (mn->y + mn->h));
+    return (max_i32(dx, 0) + max_i32(dy, 0));
+}
+
+void map_prefetch_update(g_s *g)
+{
+    // don't compete with other loads, one room at a time
+    if (g->substate || asset_jobs_busy()) return;
+
+    obj_s *ohero = obj_get_hero(g);
+    if (!ohero) return;
+
+    // the closest neighbors are the ones to keep in standby
+    map_prefetch_s *p                            = &g->prefetch;
+    rec_i32         aabb                         = obj_aabb(ohero);
+    u32             want[MAP_PREFETCH_NUM_BUFS]  = {0};
+    i32             dists[MAP_PREFETCH_NUM_BUFS] = {0};
+
+    for (i32 n = 0; n < NUM_MAP_NEIGHBORS; n++) {
+        map_neighbor_s *mn = &g->map_neighbors[n];
+        if (mn->hash == 0) break;
+        if (MAP_PREFETCH_BUF_SIZE < map_prefetch_est_size(mn)) continue;
+        if (map_cache_has(&g->mapcache, mn->hash)) continue;
+
+        i32 d = map_prefetch_dist(aabb, mn);
+        for (i32 k = 0; k < MAP_PREFETCH_NUM_BUFS; k++) {
+            if (want[k] && dists[k] <= d) continue;
+            for (i32 j = MAP_PREFETCH_NUM_BUFS - 1; k < j; j--) {
+                want[j]  = want[j - 1];
+                dists[j] = dists[j - 1];
+            }
+            want[k]  = mn->hash;
+            dists[k] = d;
+            break;
+        }
+    }
+
+    for (i32 k = 0; k < MAP_PREFETCH_NUM_BUFS; k++) {
+        if (!want[k]) break;
+        if (map_prefetch_find(p, want[k])) continue;
+
+        // replace a buffer which doesn't hold one of the wanted rooms
+        for (i32 i = 0; i < MAP_PREFETCH_NUM_BUFS; i++) {
+            map_prefetch_buf_s *b      = &p->bufs[i];
+            b32                 wanted = 0;
+            for (i32 j = 0; j < MAP_PREFETCH_NUM_BUFS; j++) {
+                wanted |= b->map_hash && b->map_hash == want[j];
+            }
+            if (!wanted) {
+                map_prefetch_queue(b, want[k]);
+                return;
+            }
+        }
+        return;
+    }
+}
+
+map_prefetch_buf_s *map_prefetch_take(g_s *g, u32 map_hash)
+{
+    map_prefetch_buf_s *b = map_prefetch_find(&g->prefetch, map_hash);
+    if (!b) return 0;
+
+    asset_jobs_wait(b->job);
+    return b;
+}
+
+void map_prefetch_release(map_prefetch_buf_s *b)
+{
+    b->map_hash = 0;
+}
+
+static map_prefetch_buf_s *map_prefetch_find(map_prefetch_s *p, u32 map_hash)
+{
+    if (map_hash == 0) return 0;
+
+    for (i32 i = 0; i < MAP_PREFETCH_NUM_BUFS; i++) {
+        if (p->bufs[i].map_hash == map_hash) {
+            return &p->bufs[i];
+        }
+    }
+    return 0;
+}
+
+// a buffer is only reused once all of its jobs have completed:
+// the queue isn't busy when this is called
+static void map_prefetch_queue(map_prefetch_buf_s *b, u32 map_hash)
+{
+    b->map_hash = map_hash;
+    b->job      = ASSET_JOB_H_NULL;
+    b->pos      = 0;
+    mclr(b->layer, sizeof(b->layer));
+    mclr(b->layer_size, sizeof(b->layer_size));
+
+    // if the room isn't in a wad the buffer stays empty and the
+    // loader reports the missing file
+    wad_el_s *e = wad_el_find(map_hash, 0);
+    if (!e) return;
+
+    // baked maps don't need their raw layers
+    b32         baked = map_layer_find(e, map_layer_name[MAP_LAYER_TILES]) != 0;
+    allocator_s a     = {map_prefetch_alloc, b};
+    for (i32 i = 0; i < NUM_MAP_LAYERS; i++) {
+        if (baked && (i == MAP_LAYER_TERRAIN ||
+                      i == MAP_LAYER_BGAUTO ||
+                      i == MAP_LAYER_BGTILES)) continue;
+        // the job would find the layer of a later map
+        if (!map_layer_find(e, map_layer_name[i])) continue;
+
+        b->job = asset_job_blob_opt(e, map_layer_name[i], a,
+                                    &b->layer[i], &b->layer_size[i]);
+    }
+}
+
+// runs on the asset worker; fails if the room doesn't fit
+static void *map_prefetch_alloc(void *ctx, usize s, usize alignment)
+{
+    map_prefetch_buf_s *b = (map_prefetch_buf_s *)ctx;
+    usize               p = ((usize)b->pos + alignment - 1) & ~(alignment - 1);
+    if (sizeof(b->mem) < p + s) return 0;
+
+    b->pos = (u32)(p + s);
+    return (b->mem + p);
+}
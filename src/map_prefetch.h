@@ -0,0 +1,66 @@
+// =============================================================================
+// Copyright 2024, Lukas Wolski (the.strupf@proton.me). All rights reserved.
+// =============================================================================
+
+// Background prefetch of neighboring rooms. While playing, the compressed
+// layers of the rooms closest to the hero are decoded into standby buffers
+// through the asset job queue (worker thread on SDL, time sliced on the
+// Playdate). A slide transition into a prefetched room then only has to
+// autotile the already decoded layers and spawn the objects.
+//
+// Rooms which don't fit into a standby buffer, or layers which failed to
+// decode, are simply read from the wad as before.
+
+#ifndef MAP_PREFETCH_H
+#define MAP_PREFETCH_H
+
+#include "core/assets_jobs.h"
+#include "gamedef.h"
+
+#define MAP_PREFETCH_NUM_BUFS 2
+#ifdef PLTF_PD
+#define MAP_PREFETCH_BUF_SIZE MKILOBYTE(192)
+#else
+#define MAP_PREFETCH_BUF_SIZE MKILOBYTE(256)
+#endif
+
+enum {
+    MAP_LAYER_TERRAIN,
+    MAP_LAYER_BGAUTO,
+    MAP_LAYER_BGTILES,
+    MAP_LAYER_FLUIDS,
+    MAP_LAYER_OBJS,
+    MAP_LAYER_TILES, // baked autotiling, see map_bake_export
+    //
+    NUM_MAP_LAYERS
+};
+
+extern const char *const map_layer_name[NUM_MAP_LAYERS];
+
+// the layer of the map entry wad_el: only searches the layers following it,
+// up to the next map of the file
+wad_el_s *map_layer_find(wad_el_s *wad_el, const char *name);
+
+typedef struct {
+    u32         map_hash; // 0 if empty
+    asset_job_h job;      // last queued layer job
+    u32         pos;      // bump allocator into mem
+    void       *layer[NUM_MAP_LAYERS];
+    usize       layer_size[NUM_MAP_LAYERS];
+    ALIGNAS(16)
+    byte mem[MAP_PREFETCH_BUF_SIZE];
+} map_prefetch_buf_s;
+
+typedef struct {
+    map_prefetch_buf_s bufs[MAP_PREFETCH_NUM_BUFS];
+} map_prefetch_s;
+
+// queues the next neighboring room to decode, call once per tick
+void                map_prefetch_update(g_s *g);
+// returns the standby buffer of a room or null, waits for pending layers
+// layers which couldn't be decoded are null
+map_prefetch_buf_s *map_prefetch_take(g_s *g, u32 map_hash);
+// frees the buffer for the next room after its layers were consumed
+void                map_prefetch_release(map_prefetch_buf_s *b);
+
+#endif
@@ -0,0 +1,205 @@
+// =============================================================================
+// Copyright 2024, Lukas Wolski (the.strupf@proton.me). All rights reserved.
+// =============================================================================
+
+#include "map_prof.h"
+#include "app.h"
+#include "util/sorting.h"
+#include "util/str.h"
+
+#if PLTF_DEV_ENV
+static const char *const map_prof_name[NUM_MAP_PROF] = {
+    "WAD",
+    "HEADER",
+    "LABEL",
+    "AREA",
+    "TILES",
+    "TERRAIN",
+    "BGAUTO",
+    "BGTILES",
+    "FLUIDS",
+    "OBJREAD",
+    "OBJPARSE",
+    "ENTER",
+    "CAM"};
+
+static struct {
+    map_prof_rec_s cur;
+    f32            t_mark;
+    u32            bytes;
+} g_map_prof;
+
+typedef struct {
+    map_prof_rec_s cold;     // loaded from the wad
+    f32            t_cached; // loaded from the snapshot of the first load
+} map_prof_batch_s;
+
+static f32 map_prof_total(map_prof_rec_s *r);
+static i32 map_prof_cmp(const void *a, const void *b);
+
+void map_prof_begin(u32 map_hash)
+{
+    mclr(&g_map_prof, sizeof(g_map_prof));
+    g_map_prof.cur.map_hash = map_hash;
+    g_map_prof.t_mark       = pltf_seconds();
+}
+
+void map_prof_bytes(usize bytes)
+{
+    g_map_prof.bytes += (u32)bytes;
+}
+
+void map_prof_mark(i32 phase)
+{
+    f32 t = pltf_seconds();
+    g_map_prof.cur.t[phase] += t - g_map_prof.t_mark;
+    g_map_prof.cur.bytes[phase] += g_map_prof.bytes;
+    g_map_prof.t_mark = t;
+    g_map_prof.bytes  = 0;
+}
+
+void map_prof_log(const u8 *mapname)
+{
+    map_prof_rec_s *r     = &g_map_prof.cur;
+    i32             worst = 0;
+    u32             bytes = 0;
+    for (i32 i = 0; i < NUM_MAP_PROF; i++) {
+        bytes += r->bytes[i];
+        if (r->t[worst] < r->t[i]) {
+            worst = i;
+        }
+    }
+    pltf_log("MAP LOAD %s: %.2f ms, %u B decoded | %s %.2f ms\n",
+             mapname, map_prof_total(r) * 1000.f, bytes,
+             map_prof_name[worst], r->t[worst] * 1000.f);
+}
+
+// a map is an entry followed by its layers in the same file
+static b32 map_prof_is_map(i32 n)
+{
+    wad_s *w = &APP->wad;
+    if (w->n_entries <= n + 1) return 0;
+
+    wad_el_s *e    = &w->entries[n];
+    wad_el_s *next = &w->entries[n + 1];
+    if (e->filename != next->filename) return 0;
+
+    b32 is_layer = 0;
+    b32 by_layer = 0;
+    for (i32 i = 0; i < NUM_MAP_LAYERS; i++) {
+        u32 h = wad_hash(map_layer_name[i]);
+        is_layer |= e->hash == h;
+        by_layer |= next->hash == h;
+    }
+    return (!is_layer && by_layer);
+}
+
+// loads the room and finishes the transition into it like maptransition
+static void map_prof_load(g_s *g, u32 map_hash, map_prof_rec_s *o_rec)
+{
+    game_load_map(g, map_hash);
+    obj_s *ohero = obj_get_hero(g);
+    if (ohero) {
+        ohero->pos.x = (g->pixel_x - ohero->w) / 2;
+        ohero->pos.y = (g->pixel_y - ohero->h) / 2;
+    }
+    objs_animate(g);
+    map_prof_mark(MAP_PROF_ENTER);
+    cam_init_level(g, &g->cam);
+    map_prof_mark(MAP_PROF_CAM);
+
+    *o_rec = g_map_prof.cur;
+    mcpy(o_rec->mapname, g->mapname, sizeof(o_rec->mapname));
+}
+
+i32 map_prof_cli(i32 argc, char **argv)
+{
+    f32 t_max = 0.f; // ms, no limit if 0
+    if (1 <= argc) {
+        for (const char *c = argv[0]; '0' <= *c && *c <= '9'; c++) {
+            t_max = t_max * 10.f + (f32)(*c - '0');
+        }
+    }
+
+    pltf_internal_init();
+    if (!APP || !obj_get_hero(&APP->game)) {
+        pltf_log("mapprof: can't initialize the game\n");
+        pltf_internal_close();
+        return 1;
+    }
+    asset_jobs_wait_all();
+
+    g_s *g     = &APP->game;
+    i32  n_map = 0;
+    for (i32 n = 0; n < APP->wad.n_entries; n++) {
+        n_map += map_prof_is_map(n);
+    }
+
+    spm_push();
+    map_prof_batch_s *recs  = spm_alloctz(map_prof_batch_s, n_map);
+    i32               k     = 0;
+    i32               n_bad = 0;
+    aud_allow_playing_new_snd(0);
+    for (i32 n = 0; n < APP->wad.n_entries; n++) {
+        if (!map_prof_is_map(n)) continue;
+
+        map_prof_rec_s warm     = {0};
+        u32            map_hash = APP->wad.entries[n].hash;
+        map_cache_clr(&g->mapcache);
+        map_prof_load(g, map_hash, &recs[k].cold);
+        map_prof_load(g, map_hash, &warm);
+        recs[k].t_cached = map_prof_total(&warm);
+        k++;
+    }
+    aud_allow_playing_new_snd(1);
+    sort_array(recs, n_map, sizeof(map_prof_batch_s), map_prof_cmp);
+
+    pltf_log("%-24s %9s %9s", "MAP", "MS", "CACHED");
+    for (i32 i = 0; i < NUM_MAP_PROF; i++) {
+        pltf_log(" %8s", map_prof_name[i]);
+    }
+    pltf_log(" %9s\n", "BYTES");
+
+    for (i32 j = 0; j < n_map; j++) {
+        map_prof_rec_s *r     = &recs[j].cold;
+        f32             ms    = map_prof_total(r) * 1000.f;
+        u32             bytes = 0;
+        for (i32 i = 0; i < NUM_MAP_PROF; i++) {
+            bytes += r->bytes[i];
+        }
+
+        pltf_log("%-24s %9.2f %9.2f", r->mapname, ms, recs[j].t_cached * 1000.f);
+        for (i32 i = 0; i < NUM_MAP_PROF; i++) {
+            pltf_log(" %8.2f", r->t[i] * 1000.f);
+        }
+        pltf_log(" %9u\n", bytes);
+        if (0.f < t_max && t_max < ms) {
+            n_bad++;
+        }
+    }
+    spm_pop();
+
+    if (n_bad) {
+        pltf_log("mapprof: %i maps over %.0f ms\n", n_bad, t_max);
+    }
+    pltf_internal_close();
+    return (n_bad ? 1 : 0);
+}
+
+static f32 map_prof_total(map_prof_rec_s *r)
+{
+    f32 t = 0.f;
+    for (i32 i = 0; i < NUM_MAP_PROF; i++) {
+        t += r->t[i];
+    }
+    return t;
+}
+
+// slowest first
+static i32 map_prof_cmp(const void *a, const void *b)
+{
+    f32 ta = map_prof_total(&((map_prof_batch_s *)a)->cold);
+    f32 tb = map_prof_total(&((map_prof_batch_s *)b)->cold);
+    return (ta < tb ? +1 : (tb < ta ? -1 : 0));
+}
+#endif
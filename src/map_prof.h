@@ -0,0 +1,60 @@
+// =============================================================================
+// Copyright 2024, Lukas Wolski (the.strupf@proton.me). All rights reserved.
+// =============================================================================
+
+// Timings of room loads during development. game_load_map and the callers
+// finishing a room transition mark the end of each phase; the time since
+// the previous mark and the bytes decoded in between are attributed to it.
+//
+// The headless batch mode (--mapprof [max ms]) loads every map of the wad
+// without a window and logs a report sorted by load time. It returns
+// non-zero if a room took longer than the optional limit.
+//
+// Compiles to nothing outside of the dev environment.
+
+#ifndef MAP_PROF_H
+#define MAP_PROF_H
+
+#include "gamedef.h"
+
+enum {
+    MAP_PROF_WAD,         // wad lookup or snapshot cache hit
+    MAP_PROF_HEADER,      // header and tile layer allocation
+    MAP_PROF_AREA_LABEL,  // prerender_area_label
+    MAP_PROF_AREA,        // area_setup and areafx_*_setup
+    MAP_PROF_TILES,       // baked tiles or snapshot restore
+    MAP_PROF_TERRAIN,     // loader_load_terrain
+    MAP_PROF_BGAUTO,      // loader_load_bgauto
+    MAP_PROF_BGTILES,     // loader_load_bg
+    MAP_PROF_FLUIDS,      //
+    MAP_PROF_OBJS_READ,   // object data and snapshot store
+    MAP_PROF_OBJS_PARSE,  // spawning the objects
+    MAP_PROF_ENTER,       // placing the hero and the first animation
+    MAP_PROF_CAM,         // cam_init_level
+    //
+    NUM_MAP_PROF
+};
+
+typedef struct {
+    u32 map_hash;
+    u8  mapname[32];
+    f32 t[NUM_MAP_PROF]; // seconds
+    u32 bytes[NUM_MAP_PROF];
+} map_prof_rec_s;
+
+#if PLTF_DEV_ENV
+void map_prof_begin(u32 map_hash);
+// bytes decoded, attributed to the next phase marked
+void map_prof_bytes(usize bytes);
+void map_prof_mark(i32 phase);
+// logs the room load in progress in one line
+void map_prof_log(const u8 *mapname);
+i32  map_prof_cli(i32 argc, char **argv);
+#else
+#define map_prof_begin(H)
+#define map_prof_bytes(B)
+#define map_prof_mark(P)
+#define map_prof_log(N)
+#endif
+
+#endif
@@ -140,7 +140,10 @@ void maptransition_update(g_s *g)
     aud_allow_playing_new_snd(0); // disable sounds (foot steps etc.)
     objs_animate(g);
     aud_allow_playing_new_snd(1);
+    map_prof_mark(MAP_PROF_ENTER);
     cam_init_level(g, &g->cam);
+    map_prof_mark(MAP_PROF_CAM);
+    map_prof_log(g->mapname);
 }
 
 void maptransition_draw(g_s *g, v2_i32 cam)
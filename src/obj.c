@@ -46,6 +46,7 @@ obj_s *obj_create(g_s *g)
     o->GID           = GID;
     o->next          = g->obj_head_busy;
     g->obj_head_busy = o;
+    obj_grid_on_create(g, o);
 #if PLTF_DEBUG
     o->magic = OBJ_MAGIC;
 
@@ -124,6 +125,7 @@ void objs_cull_to_delete(g_s *g)
             }
         }
 
+        obj_grid_on_delete(g, o);
         o->next          = g->obj_head_free;
         g->obj_head_free = o;
     }
@@ -186,7 +186,6 @@ v2_i32       obj_pos_center(obj_s *o);
 void         obj_move(g_s *g, obj_s *o, i32 dx, i32 dy);
 bool32       obj_step_is_clamped(g_s *g, obj_s *o, i32 sx, i32 sy);
 void         obj_move_by_v_q8(g_s *g, obj_s *o);
-void         obj_step_solid(g_s *g, obj_s *o, i32 sx, i32 sy);
 bool32       obj_try_wiggle(g_s *g, obj_s *o);
 bool32       obj_grounded(g_s *g, obj_s *o);
 bool32       obj_grounded_at_offs(g_s *g, obj_s *o, v2_i32 offs);
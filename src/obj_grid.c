@@ -0,0 +1,312 @@
+// =============================================================================
+// Copyright 2024, Lukas Wolski (the.strupf@proton.me). All rights reserved.
+// =============================================================================
+
+#include "obj_grid.h"
+#include "game.h"
+
+static void obj_grid_sync(g_s *g);
+static void obj_grid_sync_obj(g_s *g, obj_s *o);
+static void obj_grid_reset(g_s *g);
+static void obj_grid_add(g_s *g, obj_s *o);
+static void obj_grid_remove(g_s *g, obj_s *o);
+static void obj_grid_cell_range(g_s *g, rec_i32 r, i16 *c);
+#if OBJ_GRID_VERIFY
+static void obj_grid_verify(g_s *g, rec_i32 r, u64 flags, obj_grid_q_s q);
+#endif
+
+void obj_grid_on_create(g_s *g, obj_s *o)
+{
+    obj_grid_s    *gr = &g->objgrid;
+    obj_grid_el_s *el = &gr->el[o - g->obj_raw];
+    mclr(el, sizeof(obj_grid_el_s));
+    el->seq   = ++gr->seq;
+    gr->dirty = 1;
+}
+
+void obj_grid_on_delete(g_s *g, obj_s *o)
+{
+    obj_grid_remove(g, o);
+}
+
+void obj_grid_tick(g_s *g)
+{
+    obj_grid_sync(g);
+}
+
+void obj_grid_touch(g_s *g, obj_s *o)
+{
+    obj_grid_s *gr = &g->objgrid;
+    if (gr->dirty || !gr->n_cx) { // created objects or never synced
+        obj_grid_sync(g);
+    } else {
+        obj_grid_sync_obj(g, o);
+    }
+}
+
+void obj_grid_enter(g_s *g, obj_s *o)
+{
+    obj_grid_s *gr = &g->objgrid;
+    if (gr->depth++ == 0) {
+        gr->n_cand = 0;
+        obj_grid_touch(g, o);
+    }
+}
+
+void obj_grid_exit(g_s *g)
+{
+    obj_grid_s *gr = &g->objgrid;
+    assert(0 < gr->depth);
+    gr->depth--;
+}
+
+void obj_grid_moved(g_s *g, obj_s *o)
+{
+    obj_grid_s    *gr = &g->objgrid;
+    obj_grid_el_s *el = &gr->el[o - g->obj_raw];
+    if (el->state != OBJ_GRID_CELLS) return;
+
+    rec_i32 r = {o->pos.x, o->pos.y, o->w, o->h + 1};
+    i16     c[4];
+    obj_grid_cell_range(g, r, c);
+    if (c[0] != el->cx1 || c[1] != el->cy1 ||
+        c[2] != el->cx2 || c[3] != el->cy2) {
+        obj_grid_remove(g, o);
+        obj_grid_add(g, o);
+    }
+}
+
+obj_grid_q_s obj_grid_query(g_s *g, rec_i32 r, u64 flags)
+{
+    obj_grid_s *gr = &g->objgrid;
+    if (gr->depth == 0) {
+        gr->n_cand = 0;
+    }
+    if (gr->dirty || !gr->n_cx) { // created objects or never synced
+        obj_grid_sync(g);
+    }
+
+    obj_grid_q_s q = {&gr->cand[gr->n_cand], 0};
+    if (!flags) return q;
+    if (++gr->mark == 0) {
+        for (i32 n = 0; n < NUM_OBJ; n++) {
+            gr->el[n].mark = 0;
+        }
+        gr->mark = 1;
+    }
+
+    i32 n_max = OBJ_GRID_NUM_CAND - gr->n_cand;
+    i16 c[4];
+    obj_grid_cell_range(g, r, c);
+    for (i32 cy = c[1]; cy <= c[3]; cy++) {
+        for (i32 cx = c[0]; cx <= c[2]; cx++) {
+            u16 k = gr->cells[cx + cy * gr->n_cx];
+            for (; k; k = gr->nodes[k].next) {
+                u16            i  = gr->nodes[k].obj;
+                obj_grid_el_s *el = &gr->el[i];
+                if (el->mark == gr->mark) continue;
+                el->mark = gr->mark;
+                if (!(g->obj_raw[i].flags & flags)) continue;
+                if (q.n == n_max) {
+                    BAD_PATH
+                    break;
+                }
+                q.o[q.n++] = &g->obj_raw[i];
+            }
+        }
+    }
+    for (i32 n = 0; n < gr->n_unbucketed; n++) {
+        u16 i = gr->unbucketed[n];
+        if (!(g->obj_raw[i].flags & flags)) continue;
+        if (q.n == n_max) {
+            BAD_PATH
+            break;
+        }
+        q.o[q.n++] = &g->obj_raw[i];
+    }
+
+    // most recently created first, the order of the object list
+    for (i32 i = 1; i < q.n; i++) {
+        obj_s *o = q.o[i];
+        u32    s = gr->el[o - g->obj_raw].seq;
+        i32    j = i;
+        for (; 0 < j && gr->el[q.o[j - 1] - g->obj_raw].seq < s; j--) {
+            q.o[j] = q.o[j - 1];
+        }
+        q.o[j] = o;
+    }
+    gr->n_cand += q.n;
+#if OBJ_GRID_VERIFY
+    obj_grid_verify(g, r, flags, q);
+#endif
+    return q;
+}
+
+void obj_grid_pop(g_s *g, obj_grid_q_s q)
+{
+    obj_grid_s *gr = &g->objgrid;
+    gr->n_cand     = (i32)(q.o - gr->cand);
+}
+
+// re-buckets the objects which moved since the last sync
+static void obj_grid_sync(g_s *g)
+{
+    obj_grid_s *gr   = &g->objgrid;
+    i32         n_cx = max_i32((g->pixel_x + 63) >> OBJ_GRID_CELL_SH, 1);
+    i32         n_cy = max_i32((g->pixel_y + 63) >> OBJ_GRID_CELL_SH, 1);
+    n_cx             = min_i32(n_cx, OBJ_GRID_NUM_CELLS);
+    n_cy             = min_i32(n_cy, OBJ_GRID_NUM_CELLS / n_cx);
+    if (gr->n_cx != n_cx || gr->n_cy != n_cy) {
+        gr->n_cx = n_cx;
+        gr->n_cy = n_cy;
+        obj_grid_reset(g);
+    }
+
+    for (obj_each(g, o)) {
+        obj_grid_sync_obj(g, o);
+    }
+    gr->dirty = 0;
+}
+
+static void obj_grid_sync_obj(g_s *g, obj_s *o)
+{
+    obj_grid_el_s *el = &g->objgrid.el[o - g->obj_raw];
+    b32            un = el->state == OBJ_GRID_UNBUCKETED;
+    if (el->state == OBJ_GRID_NONE ||
+        un != (o->linked_solid.o != 0)) {
+        obj_grid_remove(g, o);
+        obj_grid_add(g, o);
+    } else if (!un) {
+        obj_grid_moved(g, o);
+    }
+}
+
+static void obj_grid_reset(g_s *g)
+{
+    obj_grid_s *gr = &g->objgrid;
+    mclr(gr->cells, sizeof(gr->cells));
+    gr->n_unbucketed = 0;
+    gr->node_free    = 0;
+    for (i32 k = OBJ_GRID_NUM_NODES - 1; 1 <= k; k--) {
+        gr->nodes[k].next = gr->node_free;
+        gr->node_free     = (u16)k;
+    }
+    for (i32 n = 0; n < NUM_OBJ; n++) {
+        gr->el[n].state = OBJ_GRID_NONE;
+    }
+}
+
+static void obj_grid_add(g_s *g, obj_s *o)
+{
+    obj_grid_s    *gr = &g->objgrid;
+    u16            i  = (u16)(o - g->obj_raw);
+    obj_grid_el_s *el = &gr->el[i];
+    rec_i32        r  = {o->pos.x, o->pos.y, o->w, o->h + 1};
+    i16            c[4];
+    obj_grid_cell_range(g, r, c);
+
+    i32 n_cells = (c[2] - c[0] + 1) * (c[3] - c[1] + 1);
+    i32 n_free  = 0;
+    for (u16 k = gr->node_free; k && n_free < OBJ_GRID_MAX_CELLS; n_free++) {
+        k = gr->nodes[k].next;
+    }
+
+    if (o->linked_solid.o || min_i32(n_free, OBJ_GRID_MAX_CELLS) < n_cells) {
+        el->state                          = OBJ_GRID_UNBUCKETED;
+        gr->unbucketed[gr->n_unbucketed++] = i;
+        return;
+    }
+
+    el->state = OBJ_GRID_CELLS;
+    el->cx1   = c[0];
+    el->cy1   = c[1];
+    el->cx2   = c[2];
+    el->cy2   = c[3];
+    for (i32 cy = c[1]; cy <= c[3]; cy++) {
+        for (i32 cx = c[0]; cx <= c[2]; cx++) {
+            u16 *cell         = &gr->cells[cx + cy * gr->n_cx];
+            u16  k            = gr->node_free;
+            gr->node_free     = gr->nodes[k].next;
+            gr->nodes[k].obj  = i;
+            gr->nodes[k].next = *cell;
+            *cell             = k;
+        }
+    }
+}
+
+static void obj_grid_remove(g_s *g, obj_s *o)
+{
+    obj_grid_s    *gr = &g->objgrid;
+    u16            i  = (u16)(o - g->obj_raw);
+    obj_grid_el_s *el = &gr->el[i];
+
+    switch (el->state) {
+    case OBJ_GRID_UNBUCKETED: {
+        for (i32 n = 0; n < gr->n_unbucketed; n++) {
+            if (gr->unbucketed[n] == i) {
+                gr->unbucketed[n] = gr->unbucketed[--gr->n_unbucketed];
+                break;
+            }
+        }
+        break;
+    }
+    case OBJ_GRID_CELLS: {
+        for (i32 cy = el->cy1; cy <= el->cy2; cy++) {
+            for (i32 cx = el->cx1; cx <= el->cx2; cx++) {
+                u16 *k = &gr->cells[cx + cy * gr->n_cx];
+                while (*k && gr->nodes[*k].obj != i) {
+                    k = &gr->nodes[*k].next;
+                }
+                if (*k) {
+                    u16 kr             = *k;
+                    *k                 = gr->nodes[kr].next;
+                    gr->nodes[kr].next = gr->node_free;
+                    gr->node_free      = kr;
+                }
+            }
+        }
+        break;
+    }
+    }
+    el->state = OBJ_GRID_NONE;
+}
+
+// clamping to the border cells keeps overlapping rectangles in a common cell;
+// overlap_rec can be true for empty rectangles so they cover their corner
+static void obj_grid_cell_range(g_s *g, rec_i32 r, i16 *c)
+{
+    obj_grid_s *gr = &g->objgrid;
+    i32         x1 = min_i32(r.x, r.x + r.w);
+    i32         y1 = min_i32(r.y, r.y + r.h);
+    i32         x2 = max_i32(r.x, r.x + r.w - 1);
+    i32         y2 = max_i32(r.y, r.y + r.h - 1);
+    c[0]           = (i16)clamp_i32(x1 >> OBJ_GRID_CELL_SH, 0, gr->n_cx - 1);
+    c[1]           = (i16)clamp_i32(y1 >> OBJ_GRID_CELL_SH, 0, gr->n_cy - 1);
+    c[2]           = (i16)clamp_i32(x2 >> OBJ_GRID_CELL_SH, 0, gr->n_cx - 1);
+    c[3]           = (i16)clamp_i32(y2 >> OBJ_GRID_CELL_SH, 0, gr->n_cy - 1);
+}
+
+#if OBJ_GRID_VERIFY
+// the result has to contain every object a scan of the list could
+// act on, in list order
+static void obj_grid_verify(g_s *g, rec_i32 r, u64 flags, obj_grid_q_s q)
+{
+    i32 k = 0;
+    for (obj_each(g, o)) {
+        if (k < q.n && q.o[k] == o) {
+            k++;
+            continue;
+        }
+
+        rec_i32 ro = {o->pos.x, o->pos.y, o->w, o->h + 1};
+        if ((o->flags & flags) &&
+            (overlap_rec(r, ro) || o->linked_solid.o)) {
+            pltf_log("+++ OBJ GRID: MISSING OBJ %i (ID %i) +++\n",
+                     (i32)(o - g->obj_raw), (i32)o->ID);
+        }
+    }
+    if (k != q.n) {
+        pltf_log("+++ OBJ GRID: BAD ORDER +++\n");
+    }
+}
+#endif
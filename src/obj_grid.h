@@ -0,0 +1,102 @@
+// =============================================================================
+// Copyright 2024, Lukas Wolski (the.strupf@proton.me). All rights reserved.
+// =============================================================================
+
+// Broadphase for the object collision queries of the movement code. Objects
+// are bucketed into a uniform grid of 64 x 64 pixel cells by their aabb
+// extended by the row below it (riding checks). A query returns the objects
+// of the cells overlapping a rectangle which have any of the requested flags
+// set, ordered like obj_each: most recently created first. Loops with side
+// effects (pushing, riding, stomping) therefore run in the same order as a
+// scan of the object list. Callers still test the exact conditions.
+//
+// Game code writes object positions directly all over the place. All objects
+// are re-bucketed once per tick. Between that, obj_move re-buckets the object
+// it moves on entering and obj_grid_moved keeps it up to date after every
+// step; objs_update does the same for each object after its update.
+// Objects created since the last sync re-bucket all objects. An object whose
+// position another object writes directly may be missed until then
+// (OBJ_GRID_VERIFY logs these).
+//
+// Objects spanning too many cells or linked to a solid (see obj_step_solid)
+// aren't bucketed: they are candidates of every query.
+
+#ifndef OBJ_GRID_H
+#define OBJ_GRID_H
+
+#include "gamedef.h"
+#include "obj.h"
+
+#define OBJ_GRID_CELL_SH      6 // 64 pixels
+#define OBJ_GRID_NUM_CELLS    (NUM_TILES >> 4)
+#define OBJ_GRID_NUM_NODES    (NUM_OBJ * 4)
+#define OBJ_GRID_MAX_CELLS    8 // of an object before it's unbucketed
+#define OBJ_GRID_NUM_CAND     (NUM_OBJ * 4)
+// opt-in: compare queries, swept moves and solid steps to slow list scans
+// and per pixel steps; skews the collision and map profiler timings
+#ifndef OBJ_GRID_VERIFY
+#define OBJ_GRID_VERIFY 0
+#endif
+#define OBJ_GRID_NONE         0
+#define OBJ_GRID_CELLS        1
+#define OBJ_GRID_UNBUCKETED   2
+
+typedef struct {
+    u16 next; // 0 terminates
+    u16 obj;
+} obj_grid_node_s;
+
+typedef struct {
+    u32 seq; // creation order
+    u32 mark;
+    u8  state;
+    u8  unused;
+    i16 cx1;
+    i16 cy1;
+    i16 cx2;
+    i16 cy2;
+} obj_grid_el_s;
+
+typedef struct {
+    obj_s **o;
+    i32     n;
+} obj_grid_q_s;
+
+typedef struct {
+    i32             depth; // nesting of obj_move
+    b32             dirty; // objects created since the last sync
+    i32             n_cx;
+    i32             n_cy;
+    u32             seq;
+    u32             mark;
+    u16             node_free;
+    u16             n_unbucketed;
+    i32             n_cand;
+    u16             unbucketed[NUM_OBJ];
+    u16             cells[OBJ_GRID_NUM_CELLS];
+    obj_grid_node_s nodes[OBJ_GRID_NUM_NODES];
+    obj_grid_el_s   el[NUM_OBJ];
+    obj_s          *cand[OBJ_GRID_NUM_CAND]; // stack of query results
+    // riders of the platform in obj_move_actor, queried for its whole path
+    obj_s          *riders_of;
+    rec_i32         riders_r;
+    obj_grid_q_s    riders;
+} obj_grid_s;
+
+void         obj_grid_on_create(g_s *g, obj_s *o);
+void         obj_grid_on_delete(g_s *g, obj_s *o);
+// re-buckets all objects, call once per tick before the objects update
+void         obj_grid_tick(g_s *g);
+// call after writing the position of o directly
+void         obj_grid_touch(g_s *g, obj_s *o);
+// brackets obj_move of o; o is re-bucketed on the outermost enter
+void         obj_grid_enter(g_s *g, obj_s *o);
+void         obj_grid_exit(g_s *g);
+// call after moving an object inside of obj_move
+void         obj_grid_moved(g_s *g, obj_s *o);
+// objects with any of the flags possibly overlapping r, release with
+// obj_grid_pop in reverse order; empty if no flags are given
+obj_grid_q_s obj_grid_query(g_s *g, rec_i32 r, u64 flags);
+void         obj_grid_pop(g_s *g, obj_grid_q_s q);
+
+#endif
@@ -28,14 +28,19 @@ bool32 obj_on_platform(g_s *g, obj_s *o, i32 x, i32 y, i32 w)
         }
     }
 
-    for (obj_each(g, it)) {
+    bool32       on_plat = 0;
+    obj_grid_q_s q       = obj_grid_query(g, r, OBJ_FLAG_PLATFORM);
+    for (i32 k = 0; k < q.n; k++) {
+        obj_s *it = q.o[k];
         if (it == o) continue;
-        if (!(it->flags & OBJ_FLAG_PLATFORM)) continue;
         rec_i32 rplat = {it->pos.x, it->pos.y, it->w, 1};
-        if (overlap_rec(r, rplat))
-            return 1;
+        if (overlap_rec(r, rplat)) {
+            on_plat = 1;
+            break;
+        }
     }
-    return 0;
+    obj_grid_pop(g, q);
+    return on_plat;
 }
 
 bool32 obj_blocked_by_platform(g_s *g, obj_s *o, i32 x, i32 y, i32 w)
@@ -60,9 +65,10 @@ bool32 obj_blocked_by_platform(g_s *g, obj_s *o, i32 x, i32 y, i32 w)
         }
     }
 
-    bool32 is_plat = 0;
-
-    for (obj_each(g, it)) {
+    bool32       is_plat = 0;
+    obj_grid_q_s q       = obj_grid_query(g, r, OBJ_FLAG_PLATFORM_ANY);
+    for (i32 k = 0; k < q.n; k++) {
+        obj_s *it = q.o[k];
         if (it == o) continue;
 
         rec_i32 rplat = {it->pos.x, it->pos.y, it->w, 1};
@@ -72,13 +78,16 @@ bool32 obj_blocked_by_platform(g_s *g, obj_s *o, i32 x, i32 y, i32 w)
                        (it->flags & OBJ_FLAG_HERO_PLATFORM);
         }
     }
+    obj_grid_pop(g, q);
 
     if (o->ID == OBJID_HERO) {
         rec_i32 rstomp = r;
         rstomp.x -= HERO_W_STOMP_ADD_SYMM;
         rstomp.w += HERO_W_STOMP_ADD_SYMM * 2;
 
-        for (obj_each(g, it)) {
+        q = obj_grid_query(g, rstomp, OBJ_FLAG_HERO_JUMPSTOMPABLE);
+        for (i32 k = 0; k < q.n; k++) {
+            obj_s *it = q.o[k];
             if (it == o) continue;
 
             rec_i32 rplat = {it->pos.x, it->pos.y, it->w, 1};
@@ -93,6 +102,7 @@ bool32 obj_blocked_by_platform(g_s *g, obj_s *o, i32 x, i32 y, i32 w)
                 }
             }
         }
+        obj_grid_pop(g, q);
     }
     return is_plat;
 }
@@ -102,11 +112,15 @@ void obj_move_solid(g_s *g, obj_s *o, i32 dx, i32 dy);
 
 void obj_move(g_s *g, obj_s *o, i32 dx, i32 dy)
 {
+    i32 prof_ID = coll_prof_obj_push(o);
+    obj_grid_enter(g, o);
     if (o->flags & OBJ_FLAG_SOLID) {
         obj_move_solid(g, o, dx, dy);
     } else {
         obj_move_actor(g, o, dx, dy);
     }
+    obj_grid_exit(g);
+    coll_prof_obj_pop(prof_ID);
 }
 
 bool32 obj_step_is_clamped(g_s *g, obj_s *o, i32 sx, i32 sy)
@@ -7,10 +7,38 @@
 b32  obj_step_actor(g_s *g, obj_s *o, i32 sx, i32 sy);
 b32  obj_actor_blocked(g_s *g, obj_s *o, rec_i32 r, i32 sx, i32 sy);
 void obj_step_actor_commit(g_s *g, obj_s *o, i32 sx, i32 sy);
+i32  obj_sweep_actor(g_s *g, obj_s *o, i32 sx, i32 sy, i32 m);
+b32  obj_one_way_tile_row(g_s *g, rec_i32 rb);
+b32  obj_sweep_hit(obj_grid_q_s q, obj_s *o, rec_i32 r);
+#if OBJ_GRID_VERIFY
+static void obj_riders_verify(g_s *g, obj_s *o, obj_grid_q_s q, rec_i32 rplat);
+static void obj_sweep_verify(g_s *g, obj_s *o, i32 sx, i32 sy, i32 n);
+#endif
 
 void obj_move_actor(g_s *g, obj_s *o, i32 dx, i32 dy)
 {
-    for (i32 m = abs_i32(dx), s = 0 < dx ? +1 : -1; m; m--) {
+    // candidates for the riders of a platform along the top rows of its
+    // path, a row of slack for gluing to the ground; obj_step_actor_commit
+    // queries on its own if the platform slid out of it
+    obj_grid_s  *gr          = &g->objgrid;
+    obj_s       *riders_of   = gr->riders_of;
+    rec_i32      riders_r    = gr->riders_r;
+    obj_grid_q_s riders      = gr->riders;
+    b32          plat_riders = (o->flags & OBJ_FLAG_PLATFORM_ANY) != 0;
+    if (plat_riders) {
+        rec_i32 rq    = {min_i32(o->pos.x, o->pos.x + dx) - 1,
+                         min_i32(o->pos.y, o->pos.y + dy) - 2,
+                         o->w + abs_i32(dx) + 2,
+                         abs_i32(dy) + 5};
+        gr->riders_of = o;
+        gr->riders_r  = rq;
+        gr->riders    = obj_grid_query(g, rq, OBJ_FLAG_ACTOR);
+    }
+
+    i32 sx = 0 < dx ? +1 : -1;
+    i32 sy = 0 < dy ? +1 : -1;
+    i32 mx = abs_i32(dx) - obj_sweep_actor(g, o, sx, 0, abs_i32(dx));
+    for (i32 m = mx, s = sx; m; m--) {
         b32 was_grounded = obj_grounded(g, o);
         if (!obj_step_actor(g, o, s, 0)) break;
         // glue ground conditions
@@ -21,12 +49,135 @@ void obj_move_actor(g_s *g, obj_s *o, i32 dx, i32 dy)
             obj_step_actor(g, o, 0, +1);
         }
     }
-    for (i32 m = abs_i32(dy), s = 0 < dy ? +1 : -1; m; m--) {
+    i32 my = abs_i32(dy) - obj_sweep_actor(g, o, 0, sy, abs_i32(dy));
+    for (i32 m = my, s = sy; m; m--) {
         if (!obj_step_actor(g, o, 0, s)) break;
     }
+
+    if (plat_riders) {
+        obj_grid_pop(g, gr->riders);
+        gr->riders_of = riders_of;
+        gr->riders_r  = riders_r;
+        gr->riders    = riders;
+    }
 }
 
-b32 obj_step_actor(g_s *g, obj_s *o, i32 sx, i32 sy)
+// moves an actor up to m pixels along one axis in one go while none of the
+// steps would be blocked or have side effects, and returns the pixels moved;
+// the remaining pixels, starting at the contact, are stepped one by one
+i32 obj_sweep_actor(g_s *g, obj_s *o, i32 sx, i32 sy, i32 m)
+{
+    // riders, hero jumping, rope nodes and gluing to the ground
+    // react to every single step
+    if ((o->flags & (OBJ_FLAG_PLATFORM_ANY | OBJ_FLAG_HERO_JUMPSTOMPABLE)) ||
+        o->ropenode || o->w <= 0 || o->h <= 0 ||
+        (sx && (o->moverflags & OBJ_MOVER_GLUE_GROUND))) {
+        return 0;
+    }
+
+    i32 n = m;
+    if ((o->flags & OBJ_FLAG_CLAMP_ROOM_X) && sx) {
+        i32 d = 0 < sx ? g->pixel_x - o->pos.x - o->w : o->pos.x;
+        if (0 <= d) n = min_i32(n, d);
+    }
+    if ((o->flags & OBJ_FLAG_CLAMP_ROOM_Y) && sy) {
+        i32 d = 0 < sy ? g->pixel_y - o->pos.y - o->h : o->pos.y;
+        if (0 <= d) n = min_i32(n, d);
+    }
+    if (n <= 1) return 0;
+
+    rec_i32 r  = obj_aabb(o);
+    rec_i32 rw = {r.x + (sx < 0 ? -n : sx), r.y + (sy < 0 ? -n : sy),
+                  r.w + abs_i32(sx) * (n - 1), r.h + abs_i32(sy) * (n - 1)};
+    rec_i32 rs = {rw.x - HERO_W_STOMP_ADD_SYMM, rw.y,
+                  rw.w + HERO_W_STOMP_ADD_SYMM * 2, rw.h};
+
+    b32 terrain = o->moverflags & OBJ_MOVER_TERRAIN_COLLISIONS;
+    b32 plat    = (o->moverflags & OBJ_MOVER_ONE_WAY_PLAT) && 0 < sy;
+    b32 hero    = o->ID == OBJID_HERO;
+    u64 fs      = terrain ? OBJ_FLAG_SOLID : 0;
+    u64 fp      = plat ? OBJ_FLAG_PLATFORM_ANY : 0;
+    u64 fh      = hero ? OBJ_FLAG_HERO_JUMPSTOMPABLE : 0;
+
+    obj_grid_q_s qs = obj_grid_query(g, rw, fs);
+    obj_grid_q_s qp = obj_grid_query(g, rw, fp);
+    obj_grid_q_s qh = obj_grid_query(g, rs, fh);
+
+    i32 k = 1;
+    for (; k <= n; k++) {
+        rec_i32 ro = {r.x + sx * k, r.y + sy * k, r.w, r.h};
+        if (terrain) {
+            // the previous position is free of tiles: only the pixels
+            // entered with this step can be solid
+            rec_i32 rt = ro;
+            if (1 < k && sx) {
+                rt.x = 0 < sx ? ro.x + ro.w - 1 : ro.x;
+                rt.w = 1;
+            }
+            if (1 < k && sy) {
+                rt.y = 0 < sy ? ro.y + ro.h - 1 : ro.y;
+                rt.h = 1;
+            }
+            if (tile_map_solid(g, rt) || obj_sweep_hit(qs, 0, ro)) break;
+        }
+        if (plat) {
+            rec_i32 rb = {ro.x, ro.y + ro.h - 1, ro.w, 1};
+            if (obj_one_way_tile_row(g, rb) || obj_sweep_hit(qp, o, ro)) break;
+        }
+        if (hero) {
+            rec_i32 rstomp = {ro.x - HERO_W_STOMP_ADD_SYMM, ro.y,
+                              ro.w + HERO_W_STOMP_ADD_SYMM * 2, ro.h};
+            if (obj_sweep_hit(qh, o, rstomp)) break;
+        }
+    }
+    obj_grid_pop(g, qh);
+    obj_grid_pop(g, qp);
+    obj_grid_pop(g, qs);
+
+    n = k - 1;
+#if OBJ_GRID_VERIFY
+    obj_sweep_verify(g, o, sx, sy, n);
+#endif
+    o->pos.x += sx * n;
+    o->pos.y += sy * n;
+    obj_grid_moved(g, o);
+    return n;
+}
+
+// one-way tiles in a row of pixels at the top of a tile row
+b32 obj_one_way_tile_row(g_s *g, rec_i32 rb)
+{
+    rec_i32 rg = {0, 0, g->pixel_x, g->pixel_y};
+    rec_i32 ri;
+    if ((rb.y & 15) == 0 && intersect_rec(rb, rg, &ri)) {
+        i32 ty  = (ri.y) >> 4;
+        i32 tx0 = (ri.x) >> 4;
+        i32 tx1 = (ri.x + ri.w - 1) >> 4;
+
+        for (i32 tx = tx0; tx <= tx1; tx++) {
+            switch (g->tiles[tx + ty * g->tiles_x].collision) {
+            case TILE_ONE_WAY:
+            case TILE_LADDER_ONE_WAY:
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+// any candidate besides o with its top row overlapping r,
+// or its aabb for solids (o == 0)
+b32 obj_sweep_hit(obj_grid_q_s q, obj_s *o, rec_i32 r)
+{
+    for (i32 k = 0; k < q.n; k++) {
+        obj_s  *i  = q.o[k];
+        rec_i32 ri = {i->pos.x, i->pos.y, i->w, o ? 1 : i->h};
+        if (i != o && overlap_rec(r, ri)) return 1;
+    }
+    return 0;
+}
+
+static b32 obj_step_actor_i(g_s *g, obj_s *o, i32 sx, i32 sy)
 {
     assert(!(o->flags & OBJ_FLAG_SOLID));
     assert((abs_i32(sx) <= 1 && sy == 0) || (abs_i32(sy) <= 1 && sx == 0));
@@ -96,6 +247,14 @@ b32 obj_step_actor(g_s *g, obj_s *o, i32 sx, i32 sy)
     return 0;
 }
 
+b32 obj_step_actor(g_s *g, obj_s *o, i32 sx, i32 sy)
+{
+    u64 t0    = coll_prof_begin();
+    b32 moved = obj_step_actor_i(g, o, sx, sy);
+    coll_prof_end(COLL_PROF_STEP_ACTOR, o, t0);
+    return moved;
+}
+
 b32 obj_actor_blocked(g_s *g, obj_s *o, rec_i32 r, i32 sx, i32 sy)
 {
     if (obj_step_is_clamped(g, o, sx, sy)) return 1;
@@ -107,27 +266,13 @@ b32 obj_actor_blocked(g_s *g, obj_s *o, rec_i32 r, i32 sx, i32 sy)
     bool32 coll_platform = 0;
     if ((o->moverflags & OBJ_MOVER_ONE_WAY_PLAT) && 0 < sy) {
         // check tiles for platform
-        rec_i32 rb = {r.x + sx, r.y + r.h - 1 + sy, r.w, 1};
-        rec_i32 rg = {0, 0, g->pixel_x, g->pixel_y};
-        rec_i32 ri;
-        if ((rb.y & 15) == 0 && intersect_rec(rb, rg, &ri)) {
-            i32 ty  = (ri.y) >> 4;
-            i32 tx0 = (ri.x) >> 4;
-            i32 tx1 = (ri.x + ri.w - 1) >> 4;
-
-            for (i32 tx = tx0; tx <= tx1; tx++) {
-                switch (g->tiles[tx + ty * g->tiles_x].collision) {
-                case TILE_ONE_WAY:
-                case TILE_LADDER_ONE_WAY:
-                    coll_platform = 1;
-                    goto BREAKTXLOOP;
-                }
-            }
-        BREAKTXLOOP:;
-        }
+        rec_i32 rb    = {r.x + sx, r.y + r.h - 1 + sy, r.w, 1};
+        coll_platform = obj_one_way_tile_row(g, rb);
 
         // check objects for platform
-        for (obj_each(g, i)) {
+        obj_grid_q_s q = obj_grid_query(g, ro, OBJ_FLAG_PLATFORM_ANY);
+        for (i32 k = 0; k < q.n; k++) {
+            obj_s *i = q.o[k];
             if (i == o) continue;
 
             rec_i32 rplat = {i->pos.x, i->pos.y, i->w, 1};
@@ -138,6 +283,7 @@ b32 obj_actor_blocked(g_s *g, obj_s *o, rec_i32 r, i32 sx, i32 sy)
                                  (i->flags & OBJ_FLAG_HERO_PLATFORM);
             }
         }
+        obj_grid_pop(g, q);
     }
 
     if (o->ID == OBJID_HERO) {
@@ -147,7 +293,10 @@ b32 obj_actor_blocked(g_s *g, obj_s *o, rec_i32 r, i32 sx, i32 sy)
                           ro.w + HERO_W_STOMP_ADD_SYMM * 2,
                           ro.h};
 
-        for (obj_each(g, i)) {
+        obj_grid_q_s q = obj_grid_query(g, rstomp,
+                                        OBJ_FLAG_HERO_JUMPSTOMPABLE);
+        for (i32 k = 0; k < q.n; k++) {
+            obj_s *i = q.o[k];
             if (i == o || !(i->flags & OBJ_FLAG_HERO_JUMPSTOMPABLE))
                 continue;
             rec_i32 rplat = {i->pos.x, i->pos.y, i->w, 1};
@@ -162,6 +311,7 @@ b32 obj_actor_blocked(g_s *g, obj_s *o, rec_i32 r, i32 sx, i32 sy)
                 }
             }
         }
+        obj_grid_pop(g, q);
     }
 
     if (coll_platform) {
@@ -179,7 +329,21 @@ void obj_step_actor_commit(g_s *g, obj_s *o, i32 sx, i32 sy)
         u64 flagp = (o->flags & OBJ_FLAG_PLATFORM_ANY);
         o->flags &= ~OBJ_FLAG_PLATFORM_ANY;
         rec_i32 rplat = {o->pos.x, o->pos.y, o->w, 1};
-        for (obj_each(g, i)) {
+        // riders moved by earlier riders may have moved a pixel closer
+        rec_i32      rq = {rplat.x - 1, rplat.y - 1, rplat.w + 2, 3};
+        // the candidates of obj_move_actor while inside of its path
+        obj_grid_s  *gr = &g->objgrid;
+        rec_i32      rr = gr->riders_r;
+        b32          pq = gr->riders_of == o &&
+                 rr.x <= rq.x && rq.x + rq.w <= rr.x + rr.w &&
+                 rr.y <= rq.y && rq.y + rq.h <= rr.y + rr.h;
+        obj_grid_q_s q  = pq ? gr->riders
+                             : obj_grid_query(g, rq, OBJ_FLAG_ACTOR);
+#if OBJ_GRID_VERIFY
+        obj_riders_verify(g, o, q, rplat);
+#endif
+        for (i32 k = 0; k < q.n; k++) {
+            obj_s *i = q.o[k];
             if (!(i->flags & OBJ_FLAG_ACTOR)) continue;
             if (!(i->moverflags & OBJ_MOVER_TERRAIN_COLLISIONS)) continue;
             if (!(i->moverflags & OBJ_MOVER_ONE_WAY_PLAT)) continue;
@@ -192,11 +356,15 @@ void obj_step_actor_commit(g_s *g, obj_s *o, i32 sx, i32 sy)
                 obj_step_actor(g, i, +0, sy);
             }
         }
+        if (!pq) {
+            obj_grid_pop(g, q);
+        }
         o->flags |= flagp;
     }
 
     o->pos.x += sx;
     o->pos.y += sy;
+    obj_grid_moved(g, o);
     if (o->ropenode) {
         ropenode_move(g, o->rope, o->ropenode, sx, sy);
     }
@@ -221,3 +389,41 @@ void obj_step_actor_commit(g_s *g, obj_s *o, i32 sx, i32 sy)
         }
     }
 }
+
+#if OBJ_GRID_VERIFY
+// every actor standing on the platform has to be a candidate
+static void obj_riders_verify(g_s *g, obj_s *o, obj_grid_q_s q, rec_i32 rplat)
+{
+    for (obj_each(g, i)) {
+        if (i == o || !(i->flags & OBJ_FLAG_ACTOR) ||
+            !overlap_rec(rplat, obj_rec_bottom(i))) continue;
+
+        i32 k = 0;
+        while (k < q.n && q.o[k] != i) {
+            k++;
+        }
+        if (k == q.n) {
+            pltf_log("+++ PLATFORM: MISSING RIDER %i (ID %i) +++\n",
+                     (i32)(i - g->obj_raw), (i32)i->ID);
+        }
+    }
+}
+
+// each of the n swept steps has to be free when stepped pixel by pixel
+static void obj_sweep_verify(g_s *g, obj_s *o, i32 sx, i32 sy, i32 n)
+{
+    v2_i32 pos       = o->pos;
+    u16    bumpflags = o->bumpflags;
+    for (i32 k = 0; k < n; k++) {
+        if (obj_actor_blocked(g, o, obj_aabb(o), sx, sy)) {
+            pltf_log("+++ SWEEP: BLOCKED AT %i OF %i (ID %i, %i %i) +++\n",
+                     k + 1, n, (i32)o->ID, sx, sy);
+            break;
+        }
+        o->pos.x += sx;
+        o->pos.y += sy;
+    }
+    o->pos       = pos;
+    o->bumpflags = bumpflags;
+}
+#endif
@@ -4,22 +4,37 @@
 
 #include "game.h"
 
-void obj_step_solid(g_s *g, obj_s *o, i32 sx, i32 sy);
+static void obj_step_solid(g_s *g, obj_s *o, i32 sx, i32 sy, obj_grid_q_s q);
+#if OBJ_GRID_VERIFY
+static void obj_step_solid_verify(g_s *g, obj_s *o, obj_grid_q_s q,
+                                  rec_i32 r1, rec_i32 r2);
+#endif
 
+// the actors a solid can push or carry are queried once for its whole path:
+// linked actors are candidates of every query, riders and pushed actors are
+// inside of the path extended by a pixel, and both only move along with it
 void obj_move_solid(g_s *g, obj_s *o, i32 dx, i32 dy)
 {
+    rec_i32      rq = {min_i32(o->pos.x, o->pos.x + dx) - 1,
+                       min_i32(o->pos.y, o->pos.y + dy) - 1,
+                       o->w + abs_i32(dx) + 3,
+                       o->h + abs_i32(dy) + 3};
+    obj_grid_q_s q  = obj_grid_query(g, rq, OBJ_FLAG_ACTOR);
+
     for (i32 m = abs_i32(dx), s = 0 < dx ? +1 : -1; m; m--) {
-        obj_step_solid(g, o, s, 0);
+        obj_step_solid(g, o, s, 0, q);
     }
     for (i32 m = abs_i32(dy), s = 0 < dy ? +1 : -1; m; m--) {
-        obj_step_solid(g, o, 0, s);
+        obj_step_solid(g, o, 0, s, q);
     }
+    obj_grid_pop(g, q);
 }
 
-void obj_step_solid(g_s *g, obj_s *o, i32 sx, i32 sy)
+static void obj_step_solid(g_s *g, obj_s *o, i32 sx, i32 sy, obj_grid_q_s q)
 {
     assert(!(o->flags & OBJ_FLAG_ACTOR) && (o->flags & OBJ_FLAG_SOLID));
     assert((abs_i32(sx) == 1 && sy == 0) || (abs_i32(sy) == 1 && sx == 0));
+    u64 t0 = coll_prof_begin();
 
     rec_i32 r1 = {o->pos.x, o->pos.y, o->w, o->h};
     rec_i32 r2 = {o->pos.x + sx, o->pos.y + sy, o->w, o->h};
@@ -52,6 +67,7 @@ void obj_step_solid(g_s *g, obj_s *o, i32 sx, i32 sy)
     }
     o->pos.x += sx;
     o->pos.y += sy;
+    obj_grid_moved(g, o);
 
     if (gh && gh->state && !gh_was_pushed && o == obj_from_obj_handle(gh->o2)) {
         if (map_blocked_pt(g, gh->p.x, gh->p.y) ||
@@ -66,8 +82,13 @@ void obj_step_solid(g_s *g, obj_s *o, i32 sx, i32 sy)
         }
     }
 
+    // actors pushed or riding, and those linked anywhere in the room
+#if OBJ_GRID_VERIFY
+    obj_step_solid_verify(g, o, q, r1, r2);
+#endif
     o->flags &= ~OBJ_FLAG_SOLID;
-    for (obj_each(g, i)) {
+    for (i32 k = 0; k < q.n; k++) {
+        obj_s *i = q.o[k];
         if ((i->flags & OBJ_FLAG_ACTOR) &&
             (i->moverflags & OBJ_MOVER_TERRAIN_COLLISIONS)) {
             b32 linked = o == obj_from_obj_handle(i->linked_solid);
@@ -81,4 +102,29 @@ void obj_step_solid(g_s *g, obj_s *o, i32 sx, i32 sy)
         }
     }
     o->flags |= OBJ_FLAG_SOLID;
-}
\ No newline at end of file
+    coll_prof_end(COLL_PROF_STEP_SOLID, o, t0);
+}
+
+#if OBJ_GRID_VERIFY
+// every actor this step acts on has to be a candidate of the path
+static void obj_step_solid_verify(g_s *g, obj_s *o, obj_grid_q_s q,
+                                  rec_i32 r1, rec_i32 r2)
+{
+    for (obj_each(g, i)) {
+        if (!(i->flags & OBJ_FLAG_ACTOR) ||
+            !(i->moverflags & OBJ_MOVER_TERRAIN_COLLISIONS)) continue;
+        if (!(o == obj_from_obj_handle(i->linked_solid) ||
+              overlap_rec(r2, obj_aabb(i)) ||
+              overlap_rec(r1, obj_rec_bottom(i)))) continue;
+
+        i32 k = 0;
+        while (k < q.n && q.o[k] != i) {
+            k++;
+        }
+        if (k == q.n) {
+            pltf_log("+++ SOLID: MISSING ACTOR %i (ID %i) +++\n",
+                     (i32)(i - g->obj_raw), (i32)i->ID);
+        }
+    }
+}
+#endif
\ No newline at end of file
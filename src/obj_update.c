@@ -8,6 +8,7 @@ void objs_update(g_s *g)
 {
     for (obj_each(g, o)) {
         o->v_prev_q8 = o->v_q8;
+        i32 prof_ID  = coll_prof_obj_push(o);
 
         switch (o->ID) {
         default: break;
@@ -44,5 +45,7 @@ void objs_update(g_s *g)
         case OBJID_BITER: biter_on_update(g, o); break;
         case OBJID_WATERCOL: watercol_on_update(g, o); break;
         }
+        obj_grid_touch(g, o);
+        coll_prof_obj_pop(prof_ID);
     }
 }
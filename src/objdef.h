@@ -72,6 +72,8 @@ enum {
     OBJID_TIMER,
     OBJID_BOSS_GOLEM,
     OBJID_BOSS_GOLEM_PLATFORM,
+    //
+    NUM_OBJID
 };
 
 enum {
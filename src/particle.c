@@ -5,6 +5,12 @@
 #include "particle.h"
 #include "game.h"
 
+static void particles_set(particles_s *pr, i32 i, particle_s *p);
+static void particles_del(particles_s *pr, i32 i);
+static i32  particles_run(g_s *g, i32 x, i32 y, i32 sx, i32 sy, i32 m);
+
+// particles only collide with the tiles: the collision mask is
+// tile_map_solid_pt, objects aren't looked at
 void particles_spawn(g_s *g, particle_desc_s desc, i32 n)
 {
     particles_s *pr = &g->particles;
@@ -13,17 +19,17 @@ void particles_spawn(g_s *g, particle_desc_s desc, i32 n)
         v2_i32 pos = desc.p.p_q8;
         pos.x += rngr_sym_i32(desc.pr_q8.x);
         pos.y += rngr_sym_i32(desc.pr_q8.y);
-        if (map_blocked_pt(g, pos.x >> 8, pos.y >> 8)) {
-            particle_s *p = &pr->particles[pr->n++];
-            *p            = desc.p;
-            p->p_q8       = pos;
-            p->v_q8.x += rngr_sym_i32(desc.vr_q8.x);
-            p->v_q8.y += rngr_sym_i32(desc.vr_q8.y);
-            p->a_q8.x += rngr_sym_i32(desc.ar_q8.x);
-            p->a_q8.y += rngr_sym_i32(desc.ar_q8.y);
-            p->size += rngr_i32(0, desc.sizer);
-            p->ticks_max += rngr_i32(0, desc.ticksr);
-            p->ticks = p->ticks_max;
+        if (tile_map_solid_pt(g, pos.x >> 8, pos.y >> 8)) {
+            particle_s p = desc.p;
+            p.p_q8       = pos;
+            p.v_q8.x += rngr_sym_i32(desc.vr_q8.x);
+            p.v_q8.y += rngr_sym_i32(desc.vr_q8.y);
+            p.a_q8.x += rngr_sym_i32(desc.ar_q8.x);
+            p.a_q8.y += rngr_sym_i32(desc.ar_q8.y);
+            p.size += rngr_i32(0, desc.sizer);
+            p.ticks_max += rngr_i32(0, desc.ticksr);
+            p.ticks = p.ticks_max;
+            particles_set(pr, pr->n++, &p);
             if (pr->n == PARTICLE_NUM) return;
         }
     }
@@ -32,39 +38,45 @@ void particles_spawn(g_s *g, particle_desc_s desc, i32 n)
 void particles_update(g_s *g, particles_s *pr)
 {
     for (i32 i = pr->n - 1; 0 <= i; i--) {
-        particle_s *p  = &pr->particles[i];
-        v2_i32      p0 = v2_shr(p->p_q8, 8);
-        if (--p->ticks <= 0 || !map_blocked_pt(g, p0.x, p0.y)) {
-            *p = pr->particles[--pr->n];
-            continue;
+        if (--pr->ticks[i] <= 0 ||
+            !tile_map_solid_pt(g, pr->px_q8[i] >> 8, pr->py_q8[i] >> 8)) {
+            particles_del(pr, i);
         }
+    }
 
-        p->v_q8   = v2_add(p->v_q8, p->a_q8);
-        v2_i32 pp = v2_add(p->p_q8, p->v_q8);  // proposed new position
-        v2_i32 pd = v2_sub(v2_shr(pp, 8), p0); // delta in pixels
+    for (i32 i = 0; i < pr->n; i++) {
+        pr->vx_q8[i] += pr->ax_q8[i];
+        pr->vy_q8[i] += pr->ay_q8[i];
+    }
 
-        for (i32 m = abs_i32(pd.x), s = sgn_i32(pd.x); m; m--) {
-            if (map_blocked_pt(g, p0.x + s, p0.y)) {
-                p0.x += s;
-            } else {
-                p->v_q8.x = -(p->v_q8.x >> 1); // bounce off
-                pp.x      = p0.x << 8;
-                break;
+    for (i32 i = 0; i < pr->n; i++) {
+        i32 x  = pr->px_q8[i] >> 8;
+        i32 y  = pr->py_q8[i] >> 8;
+        i32 px = pr->px_q8[i] + pr->vx_q8[i]; // proposed new position
+        i32 py = pr->py_q8[i] + pr->vy_q8[i];
+        i32 dx = (px >> 8) - x; // delta in pixels
+        i32 dy = (py >> 8) - y;
+
+        if (dx) {
+            i32 s = sgn_i32(dx);
+            i32 m = particles_run(g, x, y, s, 0, abs_i32(dx));
+            x += s * m;
+            if (m < abs_i32(dx)) {
+                pr->vx_q8[i] = -(pr->vx_q8[i] >> 1); // bounce off
+                px           = x << 8;
             }
         }
-
-        for (i32 m = abs_i32(pd.y), s = sgn_i32(pd.y); m; m--) {
-            if (map_blocked_pt(g, p0.x, p0.y + s)) {
-                p0.y += s;
-            } else {
-                p->v_q8.y = -(p->v_q8.y >> 1); // bounce off
-                p->p_q8.y = p0.y << 8;
-                pp.y      = p0.y << 8;
-                break;
+        if (dy) {
+            i32 s = sgn_i32(dy);
+            i32 m = particles_run(g, x, y, 0, s, abs_i32(dy));
+            y += s * m;
+            if (m < abs_i32(dy)) {
+                pr->vy_q8[i] = -(pr->vy_q8[i] >> 1); // bounce off
+                py           = y << 8;
             }
         }
-
-        p->p_q8 = pp;
+        pr->px_q8[i] = px;
+        pr->py_q8[i] = py;
     }
 }
 
@@ -72,22 +84,101 @@ void particles_draw(g_s *g, particles_s *pr, v2_i32 cam)
 {
     gfx_ctx_s ctx = gfx_ctx_display();
     for (i32 i = 0; i < pr->n; i++) {
-        particle_s *p           = &pr->particles[i];
-        v2_i32      ppos        = v2_add(v2_shr(p->p_q8, 8), cam);
-        gfx_ctx_s   ctxparticle = ctx;
-        ctxparticle.pat         = gfx_pattern_interpolate(p->ticks, p->ticks_max);
+        v2_i32    ppos        = {(pr->px_q8[i] >> 8) + cam.x,
+                                 (pr->py_q8[i] >> 8) + cam.y};
+        gfx_ctx_s ctxparticle = ctx;
+        ctxparticle.pat       = gfx_pattern_interpolate(pr->ticks[i],
+                                                        pr->ticks_max[i]);
 
-        switch (p->gfx) {
+        switch (pr->gfx[i]) {
         case PARTICLE_GFX_CIR: {
-            gfx_cir_fill(ctxparticle, ppos, p->size, p->col);
+            gfx_cir_fill(ctxparticle, ppos, pr->size[i], pr->col[i]);
         } break;
         case PARTICLE_GFX_REC: {
-            rec_i32 rr = {ppos.x, ppos.y, p->size, p->size};
-            gfx_rec_fill(ctxparticle, rr, p->col);
+            rec_i32 rr = {ppos.x, ppos.y, pr->size[i], pr->size[i]};
+            gfx_rec_fill(ctxparticle, rr, pr->col[i]);
         } break;
         case PARTICLE_GFX_SPR: {
-            gfx_spr(ctxparticle, p->texrec, ppos, 0, 0);
+            gfx_spr(ctxparticle, pr->texrec[i], ppos, 0, 0);
         } break;
         }
     }
-}
\ No newline at end of file
+}
+
+static void particles_set(particles_s *pr, i32 i, particle_s *p)
+{
+    pr->px_q8[i]     = p->p_q8.x;
+    pr->py_q8[i]     = p->p_q8.y;
+    pr->vx_q8[i]     = p->v_q8.x;
+    pr->vy_q8[i]     = p->v_q8.y;
+    pr->ax_q8[i]     = p->a_q8.x;
+    pr->ay_q8[i]     = p->a_q8.y;
+    pr->ticks[i]     = p->ticks;
+    pr->ticks_max[i] = p->ticks_max;
+    pr->size[i]      = p->size;
+    pr->gfx[i]       = p->gfx;
+    pr->col[i]       = p->col;
+    pr->texrec[i]    = p->texrec;
+}
+
+// replaced by the last one
+static void particles_del(particles_s *pr, i32 i)
+{
+    i32 l            = --pr->n;
+    pr->px_q8[i]     = pr->px_q8[l];
+    pr->py_q8[i]     = pr->py_q8[l];
+    pr->vx_q8[i]     = pr->vx_q8[l];
+    pr->vy_q8[i]     = pr->vy_q8[l];
+    pr->ax_q8[i]     = pr->ax_q8[l];
+    pr->ay_q8[i]     = pr->ay_q8[l];
+    pr->ticks[i]     = pr->ticks[l];
+    pr->ticks_max[i] = pr->ticks_max[l];
+    pr->size[i]      = pr->size[l];
+    pr->gfx[i]       = pr->gfx[l];
+    pr->col[i]       = pr->col[l];
+    pr->texrec[i]    = pr->texrec[l];
+}
+
+// number of steps up to m along an axis onto pixels of the collision mask;
+// runs through a word of the pixel bitmap or a tile at a time
+static i32 particles_run(g_s *g, i32 x, i32 y, i32 sx, i32 sy, i32 m)
+{
+    i32 k = 0;
+    while (k < m) {
+        i32 px = x + sx * (k + 1);
+        i32 py = y + sy * (k + 1);
+        if (!(0 <= px && px < g->pixel_x && 0 <= py && py < g->pixel_y)) break;
+
+        i32 n = 0; // steps onto the mask
+        i32 e = 0; // steps until the end of the word or tile
+        if (sx && g->tiles_px) {
+            u32 w = bswap32(g->tiles_px[py * ((g->tiles_x + 1) >> 1) + (px >> 5)]);
+            i32 b = px & 31;
+            if (0 < sx) {
+                u32 v = ~w << b; // pixel px at the top bit
+                e     = 32 - b;
+                n     = v ? clz32(v) : e;
+            } else {
+                u32 v = ~w >> (31 - b); // pixel px at the bottom bit
+                e     = b + 1;
+                n     = v ? 31 - clz32(v & (~v + 1)) : e;
+            }
+        } else {
+            tile_s t = g->tiles[(px >> 4) + (py >> 4) * g->tiles_x];
+            e        = sx ? (0 < sx ? 16 - (px & 15) : (px & 15) + 1)
+                          : (0 < sy ? 16 - (py & 15) : (py & 15) + 1);
+            if (t.collision == TILE_BLOCK) {
+                n = e;
+            } else {
+                while (n < e && tile_solid_pt(t.collision,
+                                              (px + sx * n) & 15,
+                                              (py + sy * n) & 15)) {
+                    n++;
+                }
+            }
+        }
+        k += n;
+        if (n < e) break;
+    }
+    return min_i32(k, m);
+}
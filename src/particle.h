@@ -89,9 +89,22 @@ typedef struct {
     i16    sizer;
 } particle_desc_s;
 
+// structure of arrays: the update runs over the hot arrays in batches
 typedef struct {
-    i32        n;
-    particle_s particles[PARTICLE_NUM];
+    i32      n;
+    i32      px_q8[PARTICLE_NUM];
+    i32      py_q8[PARTICLE_NUM];
+    i32      vx_q8[PARTICLE_NUM];
+    i32      vy_q8[PARTICLE_NUM];
+    i32      ax_q8[PARTICLE_NUM];
+    i32      ay_q8[PARTICLE_NUM];
+    i16      ticks[PARTICLE_NUM];
+    // only drawn
+    i16      ticks_max[PARTICLE_NUM];
+    i16      size[PARTICLE_NUM];
+    u8       gfx[PARTICLE_NUM];
+    u8       col[PARTICLE_NUM];
+    texrec_s texrec[PARTICLE_NUM];
 } particles_s;
 
 void particles_spawn(g_s *g, particle_desc_s desc, i32 n);
@@ -32,6 +32,13 @@
 #define PLTF_ACCELEROMETER_SUPPORT 0
 #endif
 
+// background threads: not available on the Playdate or the web build
+#if defined(PLTF_PD) || defined(__EMSCRIPTEN__)
+#define PLTF_THREADS 0
+#else
+#define PLTF_THREADS 1
+#endif
+
 enum {
     PLTF_FILE_MODE_R,
     PLTF_FILE_MODE_W,
@@ -82,6 +89,19 @@ i32    pltf_file_w(void *f, const void *buf, usize bsize);
 i32    pltf_file_r(void *f, void *buf, usize bsize);
 b32    pltf_file_ws(void *f, const void *buf, usize bsize);
 b32    pltf_file_rs(void *f, void *buf, usize bsize);
+#if PLTF_THREADS
+void  *pltf_thread_create(i32 (*func)(void *ctx), void *ctx);
+i32    pltf_thread_join(void *t);
+void   pltf_thread_sleep(i32 ms);
+i32    pltf_num_cpus();
+void  *pltf_mutex_create();
+void   pltf_mutex_destroy(void *m);
+void   pltf_mutex_lock(void *m);
+void   pltf_mutex_unlock(void *m);
+#else
+#define pltf_mutex_lock(M)
+#define pltf_mutex_unlock(M)
+#endif
 i32    pltf_internal_init();
 i32    pltf_internal_update();
 void   pltf_internal_audio(i16 *lbuf, i16 *rbuf, i32 len);
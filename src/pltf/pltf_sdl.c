@@ -4,6 +4,8 @@
 
 #include "pltf_sdl.h"
 #include "pltf.h"
+#include "map_prof.h"
+#include "wad_pack.h"
 
 #ifdef __EMSCRIPTEN__
 #include <emscripten.h>
@@ -75,6 +77,15 @@ void pltf_sdl_audio(void *u, u8 *stream, int len);
 
 int main(int argc, char **argv)
 {
+#if PLTF_DEV_ENV
+    if (2 <= argc && strcmp(argv[1], "--wadpack") == 0) {
+        return (int)wad_pack_cli(argc - 2, argv + 2);
+    }
+    if (2 <= argc && strcmp(argv[1], "--mapprof") == 0) { // no window
+        g_SDL.timeorigin = SDL_GetPerformanceCounter();
+        return (int)map_prof_cli(argc - 2, argv + 2);
+    }
+#endif
     SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "0");
     SDL_SetHint(SDL_HINT_WINDOWS_DPI_AWARENESS, "system");
     SDL_Init(SDL_INIT_EVENTS |
@@ -515,6 +526,70 @@ i32 pltf_file_r(void *f, void *buf, usize bsize)
     return (i32)fread(buf, 1, bsize, f);
 }
 
+#if PLTF_THREADS
+typedef struct {
+    i32 (*func)(void *ctx);
+    void *ctx;
+} pltf_sdl_thread_s;
+
+static int pltf_sdl_thread_func(void *data)
+{
+    pltf_sdl_thread_s t = *(pltf_sdl_thread_s *)data;
+    free(data);
+    return (int)t.func(t.ctx);
+}
+
+void *pltf_thread_create(i32 (*func)(void *ctx), void *ctx)
+{
+    pltf_sdl_thread_s *t = (pltf_sdl_thread_s *)malloc(sizeof(pltf_sdl_thread_s));
+    if (!t) return 0;
+    t->func          = func;
+    t->ctx           = ctx;
+    SDL_Thread *thrd = SDL_CreateThread(pltf_sdl_thread_func, "pltf", t);
+    if (!thrd) {
+        free(t);
+    }
+    return thrd;
+}
+
+i32 pltf_thread_join(void *t)
+{
+    int res = 0;
+    SDL_WaitThread((SDL_Thread *)t, &res);
+    return (i32)res;
+}
+
+void pltf_thread_sleep(i32 ms)
+{
+    SDL_Delay((Uint32)ms);
+}
+
+i32 pltf_num_cpus()
+{
+    return (i32)SDL_GetCPUCount();
+}
+
+void *pltf_mutex_create()
+{
+    return SDL_CreateMutex();
+}
+
+void pltf_mutex_destroy(void *m)
+{
+    SDL_DestroyMutex((SDL_mutex *)m);
+}
+
+void pltf_mutex_lock(void *m)
+{
+    SDL_LockMutex((SDL_mutex *)m);
+}
+
+void pltf_mutex_unlock(void *m)
+{
+    SDL_UnlockMutex((SDL_mutex *)m);
+}
+#endif
+
 void pltf_audio_lock()
 {
     SDL_LockAudioDevice(g_SDL.audiodevID);
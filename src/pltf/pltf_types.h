@@ -101,6 +101,15 @@ typedef bool32         b32;
 
 #define ALIGNT(T) ALIGNAS(sizeof(T))
 
+// one instance of a static variable per thread
+#if defined(PLTF_PD)
+#define PLTF_THREAD_LOCAL
+#elif defined(_MSC_VER)
+#define PLTF_THREAD_LOCAL __declspec(thread)
+#else
+#define PLTF_THREAD_LOCAL __thread
+#endif
+
 #ifdef PLTF_PD_HW
 void (*PD_system_error)(const char *format, ...);
 #if 1
@@ -144,6 +153,7 @@ typedef struct {
 #define mset                  memset
 #define mcpy                  memcpy
 #define mmov                  memmove
+#define mcmp                  memcmp
 #define mclr(DST, SIZE)       mset(DST, 0, SIZE)
 #define mclr_static_arr(DST)  mset(DST, 0, sizeof(DST))
 #define POW2(X)               ((X) * (X))
@@ -141,6 +141,8 @@ static void try_add_point_in_tri(convex_vertex_s p, tri_i32 t1, tri_i32 t2,
     }
 }
 
+// tiles and objects are visited in the same order as a scan of the bounds
+// and of the object list: the order decides between collinear points
 static void rope_points_in_tris(g_s *g, tri_i32 t1, tri_i32 t2, ropepts_s *pts)
 {
     assert(v2_crs(v2_sub(t1.p[2], t1.p[0]), v2_sub(t1.p[1], t1.p[0])) != 0);
@@ -154,8 +156,25 @@ static void rope_points_in_tris(g_s *g, tri_i32 t1, tri_i32 t2, ropepts_s *pts)
                                                    v2_min(pmin1, pmin2),
                                                    v2_max(pmax1, pmax2));
 
-    for (i32 y = bounds.y1; y <= bounds.y2; y++) {
-        for (i32 x = bounds.x1; x <= bounds.x2; x++) {
+    // a point inside of both triangles is inside of the overlap of their
+    // bounding boxes: only tiles with a corner in it
+    v2_i32 bmin = v2_max(pmin1, pmin2);
+    v2_i32 bmax = v2_min(pmax1, pmax2);
+    if (bmax.x < bmin.x || bmax.y < bmin.y) return;
+    i32 x1 = max_i32(bounds.x1, (bmin.x - 1) >> 4);
+    i32 y1 = max_i32(bounds.y1, (bmin.y - 1) >> 4);
+    i32 x2 = min_i32(bounds.x2, bmax.x >> 4);
+    i32 y2 = min_i32(bounds.y2, bmax.y >> 4);
+
+    for (i32 y = y1; y <= y2; y++) {
+        for (i32 x = x1; x <= x2; x++) {
+            // skip the tiles closer to this one than the nearest shape
+            i32 d = g->tiles_dist ? g->tiles_dist[x + y * g->tiles_x] : 0;
+            if (d) {
+                x += d - 1;
+                continue;
+            }
+
             i32 t = g->tiles[x + y * g->tiles_x].collision;
             if (!(0 < t && t < NUM_TILE_SHAPES)) continue;
             v2_i32 pos = {x << 4, y << 4};
@@ -188,8 +207,12 @@ static void rope_points_in_tris(g_s *g, tri_i32 t1, tri_i32 t2, ropepts_s *pts)
 
     for (obj_each(g, o)) {
         if (!(o->flags & OBJ_FLAG_SOLID)) continue;
+        rec_i32 ro = obj_aabb(o);
+        if (ro.x + ro.w < bmin.x || bmax.x < ro.x ||
+            ro.y + ro.h < bmin.y || bmax.y < ro.y) continue;
+
         v2_i32 p[4];
-        points_from_rec(obj_aabb(o), p);
+        points_from_rec(ro, p);
 
         convex_vertex_s v0 = {p[0], p[1], p[2]};
         convex_vertex_s v1 = {p[1], p[2], p[3]};
@@ -444,8 +467,17 @@ void tighten_ropesegment(g_s *g, rope_s *r,
     tri_i32           trispan = {{pprev, pcurr, pnext}};
     tile_map_bounds_s bounds  = tile_map_bounds_tri(g, trispan);
 
-    for (i32 y = bounds.y1; y <= bounds.y2; y++) {
-        for (i32 x = bounds.x1; x <= bounds.x2; x++) {
+    // only corners at pcurr count: the tiles around it if it's on the grid
+    i32 x1 = max_i32(bounds.x1, (pcurr.x >> 4) - 1);
+    i32 y1 = max_i32(bounds.y1, (pcurr.y >> 4) - 1);
+    i32 x2 = min_i32(bounds.x2, pcurr.x >> 4);
+    i32 y2 = min_i32(bounds.y2, pcurr.y >> 4);
+    if ((pcurr.x & 15) || (pcurr.y & 15)) {
+        y2 = y1 - 1;
+    }
+
+    for (i32 y = y1; y <= y2; y++) {
+        for (i32 x = x1; x <= x2; x++) {
             i32 t = g->tiles[x + y * g->tiles_x].collision;
             if (!TILE_IS_SHAPE(t)) continue;
 
@@ -473,8 +505,12 @@ void tighten_ropesegment(g_s *g, rope_s *r,
 
     for (obj_each(g, o)) {
         if (!(o->flags & OBJ_FLAG_SOLID)) continue;
+        rec_i32 ro = obj_aabb(o);
+        if (pcurr.x < ro.x || ro.x + ro.w < pcurr.x ||
+            pcurr.y < ro.y || ro.y + ro.h < pcurr.y) continue;
+
         v2_i32 p[4];
-        points_from_rec(obj_aabb(o), p);
+        points_from_rec(ro, p);
         if (rope_pt_convex(z, p[0], p[3], p[1], pcurr, ctop, cton) ||
             rope_pt_convex(z, p[1], p[0], p[2], pcurr, ctop, cton) ||
             rope_pt_convex(z, p[2], p[1], p[3], pcurr, ctop, cton) ||
@@ -586,102 +622,166 @@ ropenode_s *ropenode_neighbour(rope_s *r, ropenode_s *rn)
     return (rn->next ? rn->next : rn->prev);
 }
 
+// a verlet point is pinned to the first corner mapped to its index
 typedef struct {
-    i32    i;
-    v2_i32 p;
-} verlet_pos_s;
+    i32    n;
+    u8     i[ROPE_VERLET_N];
+    b8     pinned[ROPE_VERLET_N];
+    v2_i32 p[ROPE_VERLET_N];
+} rope_pins_s;
+
+static i32  rope_verletsim_passes(g_s *g, rope_s *r, b32 early_out);
+static void rope_pin(rope_pins_s *pins, i32 i, v2_i32 p);
 
 void rope_verletsim(g_s *g, rope_s *r)
 {
+    rope_verletsim_passes(g, r, 1);
+}
+
+// returns the number of constraint passes; once a pass neither corrects a
+// segment nor moves a pinned point every following pass wouldn't either
+static i32 rope_verletsim_passes(g_s *g, rope_s *r, b32 early_out)
+{
+    i32 *x  = r->pt_x;
+    i32 *y  = r->pt_y;
+    i32 *px = r->pt_px;
+    i32 *py = r->pt_py;
 
     // calculated current length in Q8
-    u32          ropelen_q8 = 1 + (rope_len_q4(g, r) << 4); // +1 to avoid div 0
-    i32          n_vpos     = 0;
-    verlet_pos_s vpos[64]   = {0};
-    verlet_pos_s vp_beg     = {0, v2_shl(r->tail->p, 8)};
-    vpos[n_vpos++]          = vp_beg;
+    u32         ropelen_q8 = 1 + (rope_len_q4(g, r) << 4); // +1 to avoid div 0
+    rope_pins_s pins       = {0};
+    rope_pin(&pins, 0, v2_shl(r->tail->p, 8));
 
     u32 dista = 0;
     for (ropenode_s *r1 = r->tail, *r2 = r1->prev; r2; r1 = r2, r2 = r2->prev) {
         dista += v2_lenl(v2_shl(v2_sub(r1->p, r2->p), 8));
         i32 i = (dista * ROPE_VERLET_N) / ropelen_q8;
         if (1 <= i && i < ROPE_VERLET_N - 1) {
-            verlet_pos_s vp = {i, v2_shl(r2->p, 8)};
-            vpos[n_vpos++]  = vp;
+            rope_pin(&pins, i, v2_shl(r2->p, 8));
         }
     }
-
-    verlet_pos_s vp_end = {ROPE_VERLET_N - 1, v2_shl(r->head->p, 8)};
-    vpos[n_vpos++]      = vp_end;
+    rope_pin(&pins, ROPE_VERLET_N - 1, v2_shl(r->head->p, 8));
 
     u32 ropelen_max_q8 = r->len_max_q4 << 4;
     f32 len_ratio      = min_f32(1.f, (f32)ropelen_q8 / (f32)ropelen_max_q8);
     i32 ll_q8          = (i32)((f32)ropelen_max_q8 * len_ratio) / ROPE_VERLET_N;
+    // segments shorter than this don't need a correction: dl <= ll_q8 + 1
+    u64 ls_corr        = (u64)(ll_q8 + 2) * (u64)(ll_q8 + 2);
 
     for (i32 n = 1; n < ROPE_VERLET_N - 1; n++) {
-        rope_pt_s *pt  = &r->ropept[n];
-        v2_i32     tmp = pt->p;
-        pt->p.x += (pt->p.x - pt->pp.x);
-        pt->p.y += (pt->p.y - pt->pp.y) + ROPE_VERLET_GRAV;
-        pt->pp = tmp;
+        i32 tx = x[n];
+        i32 ty = y[n];
+        x[n] += x[n] - px[n];
+        y[n] += y[n] - py[n] + ROPE_VERLET_GRAV;
+        px[n] = tx;
+        py[n] = ty;
     }
 
-    for (i32 k = 0; k < ROPE_VERLET_IT; k++) {
-        for (int n = 1; n < ROPE_VERLET_N; n++) {
-            rope_pt_s *p1 = &r->ropept[n - 1];
-            rope_pt_s *p2 = &r->ropept[n];
-
-            v2_i32 dt = v2_sub(p1->p, p2->p);
-            i32    dl = v2_lenl(dt);
-            i32    dd = dl - ll_q8;
+    i32 k = 0;
+    while (k < ROPE_VERLET_IT) {
+        k++;
+        b32 corrected = 0;
+        for (i32 n = 1; n < ROPE_VERLET_N; n++) {
+            v2_i32 dt = {x[n - 1] - x[n], y[n - 1] - y[n]};
+            if (v2_lensql(dt) < ls_corr) continue;
 
+            i32 dl = v2_lenl(dt);
+            i32 dd = dl - ll_q8;
             if (dd <= 1) continue;
-            dt    = v2_setlenl(dt, dl, dd >> 1);
-            p1->p = v2_sub(p1->p, dt);
-            p2->p = v2_add(p2->p, dt);
+            dt = v2_setlenl(dt, dl, dd >> 1);
+            x[n - 1] -= dt.x;
+            y[n - 1] -= dt.y;
+            x[n] += dt.x;
+            y[n] += dt.y;
+            corrected = 1;
         }
 
-        for (int n = n_vpos - 1; 0 <= n; n--) {
-            r->ropept[vpos[n].i].p = vpos[n].p;
+        for (i32 n = 0; n < pins.n; n++) {
+            i32 i = pins.i[n];
+            corrected |= x[i] != pins.p[i].x || y[i] != pins.p[i].y;
+            x[i] = pins.p[i].x;
+            y[i] = pins.p[i].y;
         }
+        if (early_out && !corrected) break;
     }
 
-    if (len_ratio < 0.95f) return;
+    if (len_ratio < 0.95f) return k;
 
-    // straighten rope
-    for (int n = 1; n < ROPE_VERLET_N - 1; n++) {
-        bool32 contained = 0;
-        for (int i = 0; i < n_vpos; i++) {
-            if (vpos[i].i == n) {
-                contained = 1; // is fixed to corner already
-                break;
-            }
+    // straighten rope: lerp the free points towards the straight line
+    // between the previous and next corner
+    u8 next[ROPE_VERLET_N];
+    for (i32 n = ROPE_VERLET_N - 1, i = n; 0 <= n; n--) {
+        if (pins.pinned[n]) {
+            i = n;
+        }
+        next[n] = (u8)i;
+    }
+    for (i32 n = 1, prev = 0; n < ROPE_VERLET_N - 1; n++) {
+        if (pins.pinned[n]) {
+            prev = n;
+            continue;
         }
-        if (contained) continue;
 
-        // figure out previous and next corner of verlet particle
-        verlet_pos_s prev_vp = {-1};
-        verlet_pos_s next_vp = {ROPE_VERLET_N};
+        i32    i1 = next[n];
+        v2_i32 p0 = pins.p[prev];
+        v2_i32 p1 = pins.p[i1];
+        i32    tx = lerp_i32(p0.x, p1.x, n - prev, i1 - prev);
+        i32    ty = lerp_i32(p0.y, p1.y, n - prev, i1 - prev);
+        x[n]      = lerp_i32(x[n], tx, 1, 4);
+        y[n]      = lerp_i32(y[n], ty, 1, 4);
+    }
+    return k;
+}
 
-        for (int i = 0; i < n_vpos; i++) {
-            verlet_pos_s vp = vpos[i];
-            if (prev_vp.i < vp.i && vp.i < n) {
-                prev_vp = vpos[i];
-            }
-            if (vp.i < next_vp.i && n < vp.i) {
-                next_vp = vpos[i];
-            }
-        }
+static void rope_pin(rope_pins_s *pins, i32 i, v2_i32 p)
+{
+    if (pins->pinned[i]) return;
+    pins->pinned[i]    = 1;
+    pins->p[i]         = p;
+    pins->i[pins->n++] = (u8)i;
+}
 
-        if (!(0 <= prev_vp.i && next_vp.i < ROPE_VERLET_N)) continue;
+#if PLTF_DEV_ENV
+void rope_verletsim_bench(g_s *g, rope_s *r)
+{
+    enum { N_UPDATES = 4096 };
 
-        // lerp position of particle towards straight line between corners
-        v2_i32 ptarget = v2_lerp(prev_vp.p, next_vp.p,
-                                 n - prev_vp.i,
-                                 next_vp.i - prev_vp.i);
-        r->ropept[n].p = v2_lerp(r->ropept[n].p, ptarget, 1, 4);
+    // copies share the nodes of the rope, the sim only writes the points
+    spm_push();
+    rope_s *ra = spm_alloct(rope_s, 1);
+    rope_s *rb = spm_alloct(rope_s, 1);
+
+    *ra          = *r;
+    i32 n_passes = 0;
+    f32 t0       = pltf_seconds();
+    for (i32 i = 0; i < N_UPDATES; i++) {
+        n_passes += rope_verletsim_passes(g, ra, 1);
+    }
+    f32 t1 = pltf_seconds();
+    *ra    = *r;
+    for (i32 i = 0; i < N_UPDATES; i++) {
+        rope_verletsim_passes(g, ra, 0);
     }
+    f32 t2 = pltf_seconds();
+
+    // stopping early has to result in the same shape every update
+    i32 n_bad = 0;
+    *ra       = *r;
+    *rb       = *r;
+    for (i32 i = 0; i < N_UPDATES; i++) {
+        rope_verletsim_passes(g, ra, 1);
+        rope_verletsim_passes(g, rb, 0);
+        n_bad += !!mcmp(ra->pt_x, rb->pt_x, sizeof(ra->pt_x)) ||
+                 !!mcmp(ra->pt_y, rb->pt_y, sizeof(ra->pt_y));
+    }
+    spm_pop();
+
+    pltf_log("ROPE VERLET: %.0f updates/s, %.1f passes | all passes %.0f updates/s | %i mismatches\n",
+             (f32)N_UPDATES / max_f32(t1 - t0, 0.000001f),
+             (f32)n_passes / (f32)N_UPDATES,
+             (f32)N_UPDATES / max_f32(t2 - t1, 0.000001f), n_bad);
 }
+#endif
 
 i32 rope_stretch_q8(g_s *g, rope_s *r)
 {
@@ -15,11 +15,6 @@
 typedef struct rope_s     rope_s;
 typedef struct ropenode_s ropenode_s;
 
-typedef struct rope_pt_s {
-    v2_i32 p;
-    v2_i32 pp;
-} rope_pt_s;
-
 struct ropenode_s {
     ropenode_s *next;
     ropenode_s *prev;
@@ -31,7 +26,11 @@ struct rope_s {
     u32          len_max_q4;
     obj_handle_s o_head;
     obj_handle_s o_tail;
-    rope_pt_s    ropept[ROPE_VERLET_N];
+    // verlet points in Q8, current and previous position
+    i32          pt_x[ROPE_VERLET_N];
+    i32          pt_y[ROPE_VERLET_N];
+    i32          pt_px[ROPE_VERLET_N];
+    i32          pt_py[ROPE_VERLET_N];
     //
     ropenode_s  *head;
     ropenode_s  *tail;
@@ -50,6 +49,10 @@ bool32      rope_is_intact(g_s *g, rope_s *r);
 void        rope_moved_by_aabb(g_s *g, rope_s *r, rec_i32 aabb, i32 dx, i32 dy);
 ropenode_s *ropenode_neighbour(rope_s *r, ropenode_s *rn);
 void        rope_verletsim(g_s *g, rope_s *r);
+#if PLTF_DEV_ENV
+// logs rope updates per second with and without stopping early
+void        rope_verletsim_bench(g_s *g, rope_s *r);
+#endif
 i32         rope_stretch_q8(g_s *g, rope_s *r);
 obj_s      *rope_obj_connected_to(obj_s *o);
 
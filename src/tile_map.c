@@ -5,26 +5,40 @@
 #include "tile_map.h"
 #include "game.h"
 
+// solid pixels of the shapes, one row of 16 pixels per u16 with the leftmost
+// pixel in the MSB; new shapes only need their rows here
+const u16 g_tile_masks[NUM_TILE_SHAPES][16] = {
+    {0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+     0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000}, // empty
+    {0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+     0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF}, // block
+    //
+    {0x0001, 0x0003, 0x0007, 0x000F, 0x001F, 0x003F, 0x007F, 0x00FF,
+     0x01FF, 0x03FF, 0x07FF, 0x0FFF, 0x1FFF, 0x3FFF, 0x7FFF, 0xFFFF}, // slope 45
+    {0xFFFF, 0x7FFF, 0x3FFF, 0x1FFF, 0x0FFF, 0x07FF, 0x03FF, 0x01FF,
+     0x00FF, 0x007F, 0x003F, 0x001F, 0x000F, 0x0007, 0x0003, 0x0001},
+    {0x8000, 0xC000, 0xE000, 0xF000, 0xF800, 0xFC00, 0xFE00, 0xFF00,
+     0xFF80, 0xFFC0, 0xFFE0, 0xFFF0, 0xFFF8, 0xFFFC, 0xFFFE, 0xFFFF},
+    {0xFFFF, 0xFFFE, 0xFFFC, 0xFFF8, 0xFFF0, 0xFFE0, 0xFFC0, 0xFF80,
+     0xFF00, 0xFE00, 0xFC00, 0xF800, 0xF000, 0xE000, 0xC000, 0x8000}};
+
+// collision values besides the shapes (ladders, one-ways...) are empty
+static inline const u16 *tile_mask(i32 shape)
+{
+    return g_tile_masks[(u32)shape < NUM_TILE_SHAPES ? shape : TILE_EMPTY];
+}
+
 bool32 tile_solid_pt(i32 shape, i32 x, i32 y)
 {
-    switch (shape) {
-    case TILE_BLOCK: return 1;
-    case TILE_SLOPE_45_0: return ((15 - x) <= y);
-    case TILE_SLOPE_45_3: return ((15 - x) >= y);
-    case TILE_SLOPE_45_1: return (x >= y);
-    case TILE_SLOPE_45_2: return (x <= y);
-    }
-    return 0;
+    return ((tile_mask(shape)[y] >> (15 - x)) & 1);
 }
 
 bool32 tile_solid_r(i32 shape, i32 x0, i32 y0, i32 x1, i32 y1)
 {
-    switch (shape) {
-    case TILE_BLOCK: return 1;
-    case TILE_SLOPE_45_0: return ((15 - x1) <= y1);
-    case TILE_SLOPE_45_3: return ((15 - x0) >= y0);
-    case TILE_SLOPE_45_1: return (x1 >= y0);
-    case TILE_SLOPE_45_2: return (x0 <= y1);
+    const u16 *rows = tile_mask(shape);
+    u32        m    = (0xFFFFU >> x0) & (0xFFFFU << (15 - x1));
+    for (i32 y = y0; y <= y1; y++) {
+        if (rows[y] & m) return 1;
     }
     return 0;
 }
@@ -91,7 +105,7 @@ bool32 tile_map_hookable(g_s *g, rec_i32 r)
     return 0;
 }
 
-bool32 tile_map_solid(g_s *g, rec_i32 r)
+static bool32 tile_map_solid_i(g_s *g, rec_i32 r)
 {
     rec_i32 rgrid = {0, 0, g->pixel_x, g->pixel_y};
     rec_i32 ri;
@@ -101,6 +115,30 @@ bool32 tile_map_solid(g_s *g, rec_i32 r)
     i32 py0 = ri.y;
     i32 px1 = ri.x + ri.w - 1;
     i32 py1 = ri.y + ri.h - 1;
+
+    if (g->tiles_px) {
+        i32  stride = (g->tiles_x + 1) >> 1;
+        i32  w0     = px0 >> 5;
+        i32  w1     = px1 >> 5;
+        u32  m0     = bswap32(0xFFFFFFFFU >> (px0 & 31));
+        u32  m1     = bswap32(0xFFFFFFFFU << (31 - (px1 & 31)));
+        u32 *row    = &g->tiles_px[py0 * stride];
+        if (w0 == w1) {
+            m0 &= m1;
+            for (i32 y = py0; y <= py1; y++, row += stride) {
+                if (row[w0] & m0) return 1;
+            }
+            return 0;
+        }
+        for (i32 y = py0; y <= py1; y++, row += stride) {
+            if ((row[w0] & m0) | (row[w1] & m1)) return 1;
+            for (i32 w = w0 + 1; w < w1; w++) {
+                if (row[w]) return 1;
+            }
+        }
+        return 0;
+    }
+
     i32 tx0 = px0 >> 4;
     i32 ty0 = py0 >> 4;
     i32 tx1 = px1 >> 4;
@@ -121,47 +159,170 @@ bool32 tile_map_solid(g_s *g, rec_i32 r)
     return 0;
 }
 
-bool32 tile_map_solid_pt(g_s *g, i32 x, i32 y)
+bool32 tile_map_solid(g_s *g, rec_i32 r)
+{
+    u64    t0 = coll_prof_begin();
+    bool32 s  = tile_map_solid_i(g, r);
+    coll_prof_end(COLL_PROF_TILE_SOLID, 0, t0);
+    return s;
+}
+
+static bool32 tile_map_solid_pt_i(g_s *g, i32 x, i32 y)
 {
     if (!(0 <= x && x < g->pixel_x && 0 <= y && y < g->pixel_y)) return 0;
+    if (g->tiles_px) {
+        u32 w = g->tiles_px[y * ((g->tiles_x + 1) >> 1) + (x >> 5)];
+        return ((w & bswap32(0x80000000U >> (x & 31))) != 0);
+    }
     tile_s t = g->tiles[(x >> 4) + (y >> 4) * g->tiles_x];
     return (tile_solid_pt(t.collision, x & 15, y & 15));
 }
 
-void tile_map_set_collision(g_s *g, rec_i32 r, i32 shape, i32 type)
+bool32 tile_map_solid_pt(g_s *g, i32 x, i32 y)
 {
-    i32 tx = r.x >> 4;
-    i32 ty = r.y >> 4;
-    i32 nx = r.w >> 4;
-    i32 ny = r.h >> 4;
+    u64    t0 = coll_prof_begin();
+    bool32 s  = tile_map_solid_pt_i(g, x, y);
+    coll_prof_end(COLL_PROF_TILE_SOLID, 0, t0);
+    return s;
+}
 
-    for (i32 y = 0; y < ny; y++) {
-        for (i32 x = 0; x < nx; x++) {
-            tile_s *t    = &g->tiles[x + tx + (y + ty) * g->tiles_x];
+void tile_map_set_collision(g_s *g, rec_i32 r, i32 shape, i32 type)
+{
+    // clipped: the tile layers are only as big as the map
+    i32 tx0 = max_i32(r.x >> 4, 0);
+    i32 ty0 = max_i32(r.y >> 4, 0);
+    i32 tx1 = min_i32((r.x >> 4) + (r.w >> 4), g->tiles_x);
+    i32 ty1 = min_i32((r.y >> 4) + (r.h >> 4), g->tiles_y);
+
+    for (i32 y = ty0; y < ty1; y++) {
+        for (i32 x = tx0; x < tx1; x++) {
+            tile_s *t    = &g->tiles[x + y * g->tiles_x];
             t->collision = shape;
             t->type      = type;
         }
     }
 
+    tile_map_px_update(g, tx0, ty0, tx1, ty1);
+    tile_map_dist_update(g, tx0, ty0, tx1, ty1);
     if (TILE_IS_SHAPE(shape)) {
         game_on_solid_appear(g);
     }
 }
 
-bool32 map_blocked_excl_offs(g_s *g, rec_i32 r, obj_s *o, i32 dx, i32 dy)
+usize tile_map_px_size(i32 w, i32 h)
+{
+    return (sizeof(u32) * (usize)((w + 1) >> 1) * (usize)(h << 4));
+}
+
+void tile_map_px_update(g_s *g, i32 tx0, i32 ty0, i32 tx1, i32 ty1)
+{
+    if (!g->tiles_px) return;
+
+    i32 stride = (g->tiles_x + 1) >> 1;
+    tx0        = max_i32(tx0, 0);
+    ty0        = max_i32(ty0, 0);
+    tx1        = min_i32(tx1, g->tiles_x);
+    ty1        = min_i32(ty1, g->tiles_y);
+    for (i32 ty = ty0; ty < ty1; ty++) {
+        for (i32 tx = tx0; tx < tx1; tx++) {
+            i32        n    = g->tiles[tx + ty * g->tiles_x].collision;
+            const u16 *rows = tile_mask(n);
+            u32       *p    = &g->tiles_px[(ty << 4) * stride + (tx >> 1)];
+            i32        sh   = (tx & 1) ? 0 : 16; // two tiles per word
+            u32        mk   = bswap32(0xFFFFU << sh);
+            for (i32 y = 0; y < 16; y++, p += stride) {
+                *p = (*p & ~mk) | bswap32((u32)rows[y] << sh);
+            }
+        }
+    }
+}
+
+// two pass chessboard distance transform; the capped distances of the tiles
+// up to DIST_MAX around the changed ones only depend on the solids up to
+// DIST_MAX further away
+void tile_map_dist_update(g_s *g, i32 tx0, i32 ty0, i32 tx1, i32 ty1)
+{
+    if (!g->tiles_dist) return;
+
+    const i32 m   = TILE_MAP_DIST_MAX;
+    i32       ax0 = max_i32(tx0 - m, 0);
+    i32       ay0 = max_i32(ty0 - m, 0);
+    i32       ax1 = min_i32(tx1 + m, g->tiles_x);
+    i32       ay1 = min_i32(ty1 + m, g->tiles_y);
+    i32       sx0 = max_i32(tx0 - m * 2, 0);
+    i32       sy0 = max_i32(ty0 - m * 2, 0);
+    i32       sx1 = min_i32(tx1 + m * 2, g->tiles_x);
+    i32       sy1 = min_i32(ty1 + m * 2, g->tiles_y);
+    i32       sw  = sx1 - sx0;
+    i32       sh  = sy1 - sy0;
+    if (ax1 <= ax0 || ay1 <= ay0) return;
+
+    spm_push();
+    u8 *d = (u8 *)spm_alloc((usize)sw * (usize)sh);
+    for (i32 y = 0; y < sh; y++) {
+        tile_s *t = &g->tiles[sx0 + (sy0 + y) * g->tiles_x];
+        for (i32 x = 0; x < sw; x++) {
+            d[x + y * sw] = TILE_IS_SHAPE(t[x].collision) ? 0 : m;
+        }
+    }
+
+    for (i32 y = 0; y < sh; y++) {
+        for (i32 x = 0; x < sw; x++) {
+            u8 *p = &d[x + y * sw];
+            if (0 < x) *p = min_i32(*p, p[-1] + 1);
+            if (0 < y) {
+                *p = min_i32(*p, p[-sw] + 1);
+                if (0 < x) *p = min_i32(*p, p[-sw - 1] + 1);
+                if (x < sw - 1) *p = min_i32(*p, p[-sw + 1] + 1);
+            }
+        }
+    }
+    for (i32 y = sh - 1; 0 <= y; y--) {
+        for (i32 x = sw - 1; 0 <= x; x--) {
+            u8 *p = &d[x + y * sw];
+            if (x < sw - 1) *p = min_i32(*p, p[+1] + 1);
+            if (y < sh - 1) {
+                *p = min_i32(*p, p[+sw] + 1);
+                if (0 < x) *p = min_i32(*p, p[+sw - 1] + 1);
+                if (x < sw - 1) *p = min_i32(*p, p[+sw + 1] + 1);
+            }
+        }
+    }
+
+    for (i32 y = ay0; y < ay1; y++) {
+        mcpy(&g->tiles_dist[ax0 + y * g->tiles_x],
+             &d[(ax0 - sx0) + (y - sy0) * sw],
+             (usize)(ax1 - ax0));
+    }
+    spm_pop();
+}
+
+static bool32 map_blocked_excl_offs_i(g_s *g, rec_i32 r, obj_s *o, i32 dx, i32 dy)
 {
     if (o && !(o->moverflags & OBJ_MOVER_TERRAIN_COLLISIONS)) return 0;
 
     rec_i32 ri = {r.x + dx, r.y + dy, r.w, r.h};
     if (tile_map_solid(g, ri)) return 1;
 
-    for (obj_each(g, i)) {
-        if (i != o &&
-            (i->flags & OBJ_FLAG_SOLID) &&
-            overlap_rec(r, obj_aabb(i)))
-            return 1;
+    bool32       blocked = 0;
+    obj_grid_q_s q       = obj_grid_query(g, ri, OBJ_FLAG_SOLID);
+    for (i32 k = 0; k < q.n; k++) {
+        obj_s *i = q.o[k];
+        if (i != o && overlap_rec(ri, obj_aabb(i))) {
+            blocked = 1;
+            break;
+        }
     }
-    return 0;
+    obj_grid_pop(g, q);
+    return blocked;
+}
+
+bool32 map_blocked_excl_offs(g_s *g, rec_i32 r, obj_s *o, i32 dx, i32 dy)
+{
+    u64    t0      = coll_prof_begin();
+    bool32 blocked = map_blocked_excl_offs_i(g, r, o, dx, dy);
+    coll_prof_end(COLL_PROF_MAP_BLOCKED, o, t0);
+    return blocked;
 }
 
 bool32 map_blocked_offs(g_s *g, rec_i32 r, i32 dx, i32 dy)
@@ -185,6 +346,189 @@ bool32 map_blocked_pt(g_s *g, i32 x, i32 y)
     return map_blocked_excl_offs(g, r, 0, 0, 0);
 }
 
+// coordinate of the step k of n along a line, rounded to the nearest pixel
+static inline i32 map_ray_at(i32 a, i32 d, u32 k, u32 n)
+{
+    u32 t = ((u32)abs_i32(d) * k * 2 + n) / (n * 2);
+    return (0 <= d ? a + (i32)t : a - (i32)t);
+}
+
+// first step k in [0, n] with the coordinate on the side of c given by s:
+// >= c for s > 0, <= c for s < 0; n + 1 if none
+static u32 map_ray_first(i32 a, i32 d, u32 n, i32 c, i32 s)
+{
+    u32 lo = 0;
+    u32 hi = n + 1;
+    while (lo < hi) {
+        u32 k = (lo + hi) >> 1;
+        i32 v = map_ray_at(a, d, k, n);
+        if (0 < s ? c <= v : v <= c) {
+            hi = k;
+        } else {
+            lo = k + 1;
+        }
+    }
+    return lo;
+}
+
+// steps [k0, k1) with the coordinate in [lo, hi]
+static void map_ray_span(i32 a, i32 d, u32 n, i32 lo, i32 hi,
+                         u32 *k0, u32 *k1)
+{
+    if (0 <= d) {
+        *k0 = map_ray_first(a, d, n, lo, +1);
+        *k1 = map_ray_first(a, d, n, hi + 1, +1);
+    } else {
+        *k0 = map_ray_first(a, d, n, hi, -1);
+        *k1 = map_ray_first(a, d, n, lo - 1, -1);
+    }
+}
+
+// steps [k0, k1) inside of r from step k on
+static void map_ray_span_rec(v2_i32 p0, i32 dx, i32 dy, u32 n, rec_i32 r,
+                             u32 k, u32 *k0, u32 *k1)
+{
+    u32 x0, x1, y0, y1;
+    map_ray_span(p0.x, dx, n, r.x, r.x + r.w - 1, &x0, &x1);
+    map_ray_span(p0.y, dy, n, r.y, r.y + r.h - 1, &y0, &y1);
+    *k0 = max_u32(max_u32(x0, y0), k);
+    *k1 = min_u32(x1, y1);
+}
+
+bool32 map_raycast(g_s *g, v2_i32 p0, v2_i32 p1, v2_i32 *o_hit)
+{
+    i32 dx    = p1.x - p0.x;
+    i32 dy    = p1.y - p0.y;
+    u32 n     = (u32)max_i32(abs_i32(dx), abs_i32(dy));
+    u32 k_hit = n + 1;
+    u32 k0, k1;
+    if (n == 0) {
+        *o_hit = p1;
+        return 0;
+    }
+
+    rec_i32      rb = {min_i32(p0.x, p1.x), min_i32(p0.y, p1.y),
+                       abs_i32(dx) + 1, abs_i32(dy) + 1};
+    obj_grid_q_s q  = obj_grid_query(g, rb, OBJ_FLAG_SOLID);
+    for (i32 i = 0; i < q.n; i++) {
+        map_ray_span_rec(p0, dx, dy, n, obj_aabb(q.o[i]), 1, &k0, &k1);
+        if (k0 < k1) {
+            k_hit = min_u32(k_hit, k0);
+        }
+    }
+    obj_grid_pop(g, q);
+
+    // tiles away from solid tiles let the ray skip the free space around
+    rec_i32 rmap = {0, 0, g->pixel_x, g->pixel_y};
+    for (u32 k = 1; k < k_hit;) {
+        i32 x = map_ray_at(p0.x, dx, k, n);
+        i32 y = map_ray_at(p0.y, dy, k, n);
+
+        if (!(0 <= x && x < g->pixel_x && 0 <= y && y < g->pixel_y)) {
+            // pixels outside of the map are free
+            map_ray_span_rec(p0, dx, dy, n, rmap, k, &k0, &k1);
+            if (k1 <= k0) break;
+            k = k0;
+            continue;
+        }
+
+        i32 tx   = x >> 4;
+        i32 ty   = y >> 4;
+        i32 dist = g->tiles_dist ? g->tiles_dist[tx + ty * g->tiles_x] : 0;
+        if (dist == 0) {
+            if (tile_map_solid_pt(g, x, y)) {
+                k_hit = k;
+                break;
+            }
+            k++;
+            continue;
+        }
+
+        rec_i32 rfree = {(tx - dist + 1) * 16, (ty - dist + 1) * 16,
+                         (dist * 2 - 1) * 16, (dist * 2 - 1) * 16};
+        map_ray_span_rec(p0, dx, dy, n, rfree, k, &k0, &k1);
+        k = k1;
+    }
+
+    if (k_hit <= n) {
+        o_hit->x = map_ray_at(p0.x, dx, k_hit, n);
+        o_hit->y = map_ray_at(p0.y, dy, k_hit, n);
+        return 1;
+    }
+    *o_hit = p1;
+    return 0;
+}
+
+v2_i32 map_ray_pt(v2_i32 p0, v2_i32 p1, i32 k)
+{
+    i32 dx = p1.x - p0.x;
+    i32 dy = p1.y - p0.y;
+    u32 n  = (u32)max_i32(abs_i32(dx), abs_i32(dy));
+    if (n == 0) return p0;
+
+    v2_i32 p = {map_ray_at(p0.x, dx, (u32)k, n), map_ray_at(p0.y, dy, (u32)k, n)};
+    return p;
+}
+
+#if PLTF_DEV_ENV
+void map_raycast_bench(g_s *g)
+{
+    enum { N_RAYS = 4096 };
+
+    spm_push();
+    v2_i32 *pts  = spm_alloct(v2_i32, N_RAYS * 2);
+    u32     seed = 213;
+    for (i32 i = 0; i < N_RAYS * 2; i++) {
+        seed     = seed * 1664525U + 1013904223U;
+        pts[i].x = (i32)((seed >> 8) % (u32)max_i32(g->pixel_x, 1));
+        seed     = seed * 1664525U + 1013904223U;
+        pts[i].y = (i32)((seed >> 8) % (u32)max_i32(g->pixel_y, 1));
+    }
+
+    i32 n_hits = 0;
+    f32 t0     = pltf_seconds();
+    for (i32 i = 0; i < N_RAYS; i++) {
+        v2_i32 hit;
+        n_hits += map_raycast(g, pts[i * 2], pts[i * 2 + 1], &hit);
+    }
+    f32 t1 = pltf_seconds();
+
+    // reference: testing every pixel of the rays
+    i32 n_bad = 0;
+    for (i32 i = 0; i < N_RAYS; i++) {
+        v2_i32 p0  = pts[i * 2];
+        v2_i32 p1  = pts[i * 2 + 1];
+        v2_i32 hit = p1;
+        i32    dx  = p1.x - p0.x;
+        i32    dy  = p1.y - p0.y;
+        u32    n   = (u32)max_i32(abs_i32(dx), abs_i32(dy));
+        for (u32 k = 1; k <= n; k++) {
+            i32 x = map_ray_at(p0.x, dx, k, n);
+            i32 y = map_ray_at(p0.y, dy, k, n);
+            if (map_blocked_pt(g, x, y)) {
+                hit.x = x;
+                hit.y = y;
+                break;
+            }
+        }
+
+        v2_i32 h;
+        map_raycast(g, p0, p1, &h);
+        n_bad += !v2_eq(h, hit);
+    }
+    f32 t2 = pltf_seconds();
+    spm_pop();
+
+    // the reference pass ran map_raycast once more
+    f32 t_ray = (t1 - t0) * 1000.f;
+    f32 t_ref = (t2 - t1) * 1000.f - t_ray;
+    pltf_log("RAYCAST %s: %i rays, %i hits | %.0f rays/ms | per pixel %.0f rays/ms | %i mismatches\n",
+             g->mapname, N_RAYS, n_hits,
+             (f32)N_RAYS / max_f32(t_ray, 0.001f),
+             (f32)N_RAYS / max_f32(t_ref, 0.001f), n_bad);
+}
+#endif
+
 i32 map_climbable_pt(g_s *g, i32 x, i32 y)
 {
     if (0 <= x && x < g->pixel_x && 0 <= y && y < g->pixel_y) {
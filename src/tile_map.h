@@ -7,6 +7,8 @@
 
 #include "gamedef.h"
 
+#define TILE_MAP_DIST_MAX 8 // tiles, see tile_map_dist_update
+
 enum {
     TILE_EMPTY,
     TILE_BLOCK,
@@ -111,6 +113,14 @@ bool32  tile_map_hookable(g_s *g, rec_i32 r);
 bool32  tile_map_solid(g_s *g, rec_i32 r);
 bool32  tile_map_solid_pt(g_s *g, i32 x, i32 y);
 void    tile_map_set_collision(g_s *g, rec_i32 r, i32 shape, i32 type);
+// bytes of the pixel collision bitmap of a map of w * h tiles: one bit per
+// pixel, rows of 32 bit words laid out like the display
+usize   tile_map_px_size(i32 w, i32 h);
+// rebuilds the bitmap for the tiles [tx0, tx1) x [ty0, ty1)
+void    tile_map_px_update(g_s *g, i32 tx0, i32 ty0, i32 tx1, i32 ty1);
+// distance in tiles from every tile to the nearest tile with a solid shape,
+// capped; updates the tiles affected by a change of [tx0, tx1) x [ty0, ty1)
+void    tile_map_dist_update(g_s *g, i32 tx0, i32 ty0, i32 tx1, i32 ty1);
 tile_s *tile_map_at_pos(g_s *g, v2_i32 p);
 //
 bool32  map_blocked_excl(g_s *g, rec_i32 r, obj_s *o);
@@ -118,6 +128,16 @@ bool32  map_blocked(g_s *g, rec_i32 r);
 bool32  map_blocked_excl_offs(g_s *g, rec_i32 r, obj_s *o, i32 dx, i32 dy);
 bool32  map_blocked_offs(g_s *g, rec_i32 r, i32 dx, i32 dy);
 bool32  map_blocked_pt(g_s *g, i32 x, i32 y);
+// first pixel blocked like map_blocked_pt on the line from p0 to p1, p0 not
+// tested; returns false and p1 if there is none
+bool32  map_raycast(g_s *g, v2_i32 p0, v2_i32 p1, v2_i32 *o_hit);
+// pixel of step k of the line from p0 to p1 as walked by map_raycast; a hit
+// at h is step max(|h.x - p0.x|, |h.y - p0.y|)
+v2_i32  map_ray_pt(v2_i32 p0, v2_i32 p1, i32 k);
+#if PLTF_DEV_ENV
+// logs rays per ms of map_raycast and of testing every pixel of the rays
+void    map_raycast_bench(g_s *g);
+#endif
 
 enum {
     MAP_CLIMBABLE_NO_TERRAIN,
@@ -127,6 +147,7 @@ enum {
 
 i32 map_climbable_pt(g_s *g, i32 x, i32 y);
 
+extern const u16            g_tile_masks[NUM_TILE_SHAPES][16];
 extern const tile_corners_s g_tile_corners[NUM_TILE_SHAPES];
 extern const i32            g_tile_tris[NUM_TILE_SHAPES * 12];
 
@@ -99,6 +99,7 @@ void title_start_game(g_s *g, i32 slot)
 {
     g->save_slot = slot;
     APP->state   = APP_STATE_GAME;
+    asset_jobs_wait_all(); // the game can't start without its assets
     // savefile_r(slot, &g->save);
     game_load_savefile(g);
 }
@@ -0,0 +1,275 @@
+// =============================================================================
+// Copyright 2024, Lukas Wolski (the.strupf@proton.me). All rights reserved.
+// =============================================================================
+
+#include "lz4.h"
+#include "mathfunc.h"
+#include "pltf/pltf.h"
+
+typedef struct {
+    u32 nbytes;
+    u32 size;
+} lz4_header_s;
+
+typedef struct {
+    u8 *b;        // working buffer
+    u32 i;        // current byte position in b
+    u32 n;        // valid bytes in b
+    u32 nbytes;   // bytes left to decode (stream)
+    u32 nb_lefts; // bytes still left in file
+    u32 nb_buf;   // byte capacity working buffer
+} lz4_file_decoder_s;
+
+#define LZ4_MIN_MATCH  4
+#define LZ4_MAX_OFF    (LZ4_WINDOW - 1)
+#define LZ4_MAX_CHAIN  64 // max candidates tested per position when encoding
+#define LZ4_RUN_MASK   15
+#define LZ4_WINDOW_MSK (LZ4_WINDOW - 1)
+
+static inline u32 lz4_hash(const u8 *s)
+{
+    u32 v = (u32)s[0] | ((u32)s[1] << 8) | ((u32)s[2] << 16) | ((u32)s[3] << 24);
+    return ((v * 2654435761U) >> (32 - LZ4_HASH_BITS));
+}
+
+usize lz4_decoded_size(const void *src)
+{
+    const lz4_header_s *head = (const lz4_header_s *)src;
+    return head->size;
+}
+
+usize lz4_decode(const void *src, void *dst)
+{
+    const lz4_header_s *head  = (const lz4_header_s *)src;
+    const u8           *s     = (const u8 *)(head + 1);
+    const u8           *s_end = s + head->nbytes;
+    u8                 *d     = (u8 *)dst;
+
+    while (s < s_end) {
+        u32 token = *s++;
+        u32 nlit  = token >> 4;
+        if (nlit == LZ4_RUN_MASK) {
+            u32 b;
+            do {
+                b = *s++;
+                nlit += b;
+            } while (b == 255);
+        }
+        mcpy(d, s, nlit);
+        d += nlit;
+        s += nlit;
+        if (s_end <= s) break; // last sequence: literals only
+
+        u32 off = (u32)s[0] | ((u32)s[1] << 8);
+        u32 run = LZ4_MIN_MATCH + (token & LZ4_RUN_MASK);
+        s += 2;
+        if ((token & LZ4_RUN_MASK) == LZ4_RUN_MASK) {
+            u32 b;
+            do {
+                b = *s++;
+                run += b;
+            } while (b == 255);
+        }
+
+        u8 *d_cpy = d - off;
+        if (run <= off) {
+            mcpy(d, d_cpy, run);
+            d += run;
+        } else { // overlapping run, repeats the last off bytes
+            for (u32 j = 0; j < run; j++) {
+                *d++ = *d_cpy++;
+            }
+        }
+    }
+    assert((usize)(d - (u8 *)dst) == head->size);
+    return head->size;
+}
+
+static u8 *lz4_w_len(u8 *d, u32 l)
+{
+    while (255 <= l) {
+        *d++ = 255;
+        l -= 255;
+    }
+    *d++ = (u8)l;
+    return d;
+}
+
+static u8 *lz4_w_sequence(u8 *d, const u8 *lit, u32 nlit, u32 off, u32 run)
+{
+    u8 *token = d++;
+    u32 mrun  = off ? run - LZ4_MIN_MATCH : 0;
+    *token    = (u8)((min_u32(nlit, LZ4_RUN_MASK) << 4) |
+                  min_u32(mrun, LZ4_RUN_MASK));
+    if (LZ4_RUN_MASK <= nlit) {
+        d = lz4_w_len(d, nlit - LZ4_RUN_MASK);
+    }
+    mcpy(d, lit, nlit);
+    d += nlit;
+    if (off) {
+        *d++ = (u8)(off & 0xFF);
+        *d++ = (u8)(off >> 8);
+        if (LZ4_RUN_MASK <= mrun) {
+            d = lz4_w_len(d, mrun - LZ4_RUN_MASK);
+        }
+    }
+    return d;
+}
+
+usize lz4_encode(const void *src, usize srcl, void *dst, void *work)
+{
+    lz4_header_s *head = (lz4_header_s *)dst;
+    const u8     *s    = (const u8 *)src;
+    u8           *d    = (u8 *)(head + 1);
+    u32          *htab = (u32 *)work; // last position + 1 for each hash
+    u16          *prev = (u16 *)(htab + (1 << LZ4_HASH_BITS));
+    u32           n    = 0; // index of source byte
+    u32           nlit = 0; // index of first pending literal
+    mclr(htab, sizeof(u32) * (1 << LZ4_HASH_BITS));
+
+    while (n + LZ4_MIN_MATCH <= srcl) {
+        u32 best_k = 0;
+        u32 best_l = 0;
+        u32 h      = lz4_hash(&s[n]);
+        u32 k      = htab[h];
+
+        // walk hash chain back through the window
+        for (i32 c = 0; c < LZ4_MAX_CHAIN && k && n - (k - 1) <= LZ4_MAX_OFF; c++) {
+            if (srcl <= (usize)n + best_l) break; // can't get any longer
+
+            u32 p = k - 1;
+            if (s[p + best_l] == s[n + best_l]) {
+                u32 l = 0;
+                while ((usize)(n + l) < srcl && s[p + l] == s[n + l]) {
+                    l++;
+                }
+                if (best_l < l) {
+                    best_k = p;
+                    best_l = l;
+                }
+            }
+            u32 dk = prev[p & LZ4_WINDOW_MSK];
+            k      = dk && dk < k ? k - dk : 0;
+        }
+
+        u32 n_end = LZ4_MIN_MATCH <= best_l ? n + best_l : n + 1;
+        if (LZ4_MIN_MATCH <= best_l) {
+            d    = lz4_w_sequence(d, &s[nlit], n - nlit, n - best_k, best_l);
+            nlit = n_end;
+        }
+
+        // insert covered positions into hash chains
+        for (; n < n_end; n++) {
+            if (srcl < (usize)n + LZ4_MIN_MATCH) continue;
+            u32 hn                     = lz4_hash(&s[n]);
+            u32 kn                     = htab[hn];
+            prev[n & LZ4_WINDOW_MSK] = kn && (n + 1 - kn) <= LZ4_MAX_OFF
+                                           ? (u16)(n + 1 - kn)
+                                           : 0;
+            htab[hn]                   = n + 1;
+        }
+    }
+
+    d            = lz4_w_sequence(d, &s[nlit], (u32)srcl - nlit, 0, 0);
+    usize size   = (usize)(d - (u8 *)dst);
+    head->nbytes = (u32)(size - sizeof(lz4_header_s));
+    head->size   = (u32)srcl;
+    return size;
+}
+
+static void lz4_refill_stream(void *f, lz4_file_decoder_s *s)
+{
+    s->n = s->nb_lefts < s->nb_buf ? s->nb_lefts : s->nb_buf;
+    pltf_file_r(f, s->b, (usize)s->n);
+    s->nb_lefts -= s->n;
+    s->i = 0;
+}
+
+static u32 lz4_r_byte_stream(void *f, lz4_file_decoder_s *s)
+{
+    if (s->n <= s->i) {
+        lz4_refill_stream(f, s);
+    }
+    s->nbytes--;
+    return s->b[s->i++];
+}
+
+static u32 lz4_r_len_stream(void *f, lz4_file_decoder_s *s, u32 l)
+{
+    u32 b;
+    do {
+        b = lz4_r_byte_stream(f, s);
+        l += b;
+    } while (b == 255);
+    return l;
+}
+
+// copies a run of literals straight out of the working buffer
+static u8 *lz4_r_run_stream(void *f, lz4_file_decoder_s *s, u8 *d, u32 l)
+{
+    while (l) {
+        if (s->n <= s->i) {
+            lz4_refill_stream(f, s);
+        }
+        u32 c = min_u32(l, s->n - s->i);
+        mcpy(d, &s->b[s->i], c);
+        d += c;
+        l -= c;
+        s->i += c;
+        s->nbytes -= c;
+    }
+    return d;
+}
+
+usize lz4_decode_file(void *f, void *dst)
+{
+    // working buffer for chunked reading, one per thread
+    static PLTF_THREAD_LOCAL u8 lz4_fbuf[4096];
+
+    lz4_header_s head = {0};
+    pltf_file_r(f, &head, sizeof(lz4_header_s));
+
+    lz4_file_decoder_s s = {0};
+    s.nbytes             = head.nbytes;
+    s.nb_lefts           = head.nbytes;
+    s.nb_buf             = sizeof(lz4_fbuf);
+    s.b                  = lz4_fbuf;
+    u8 *d                = (u8 *)dst;
+
+    while (s.nbytes) {
+        u32 token = lz4_r_byte_stream(f, &s);
+        u32 nlit  = token >> 4;
+        if (nlit == LZ4_RUN_MASK) {
+            nlit = lz4_r_len_stream(f, &s, nlit);
+        }
+        d = lz4_r_run_stream(f, &s, d, nlit);
+        if (s.nbytes == 0) break; // last sequence: literals only
+
+        u32 off = lz4_r_byte_stream(f, &s);
+        off |= lz4_r_byte_stream(f, &s) << 8;
+        u32 run = LZ4_MIN_MATCH + (token & LZ4_RUN_MASK);
+        if ((token & LZ4_RUN_MASK) == LZ4_RUN_MASK) {
+            run = lz4_r_len_stream(f, &s, run);
+        }
+
+        u8 *d_cpy = d - off;
+        if (run <= off) {
+            mcpy(d, d_cpy, run);
+            d += run;
+        } else { // overlapping run, repeats the last off bytes
+            for (u32 j = 0; j < run; j++) {
+                *d++ = *d_cpy++;
+            }
+        }
+    }
+    return (usize)(d - (u8 *)dst);
+}
+
+usize lz4_decode_file_peek_size(void *f)
+{
+    lz4_header_s head = {0};
+    i32          p    = pltf_file_tell(f);
+    pltf_file_r(f, &head, sizeof(lz4_header_s));
+    pltf_file_seek_set(f, p);
+    return head.size;
+}
@@ -0,0 +1,48 @@
+// =============================================================================
+// Copyright 2024, Lukas Wolski (the.strupf@proton.me). All rights reserved.
+// =============================================================================
+
+// LZ4-style byte aligned LZ77 block format. Compared to LZSS:
+// - 64 KB window instead of 1 KB
+// - unbounded literal and match runs
+// - literals and matches are copied as whole runs instead of byte by byte
+//
+// struct lz4_block {
+//    struct {
+//        u32 nbytes; // bytes of sequence data following the header
+//        u32 size;   // decoded size
+//    } header;
+//    struct {
+//        u8  token;       // hi nibble: literal run, lo nibble: match run - 4
+//        u8  lit_ext[];   // if literal nibble == 15: add bytes until != 255
+//        u8  literals[];
+//        u16 offset;      // little endian, [1, 65535] (absent in last sequence)
+//        u8  match_ext[]; // if match nibble == 15: add bytes until != 255
+//    } sequences[N];
+// };
+
+#ifndef LZ4_H
+#define LZ4_H
+
+#include "pltf/pltf_types.h"
+
+#define LZ4_HASH_BITS        12
+#define LZ4_WINDOW           65536
+#define LZ4_ENCODE_WORK_SIZE (sizeof(u32) * (1 << LZ4_HASH_BITS) + \
+                              sizeof(u16) * LZ4_WINDOW)
+
+// worst case size of an encoded block including the header
+static inline usize lz4_encode_bound(usize srcl)
+{
+    return (8 + srcl + srcl / 255 + 16);
+}
+
+usize lz4_decoded_size(const void *src);
+usize lz4_decode(const void *src, void *dst);
+// work: scratch memory of at least LZ4_ENCODE_WORK_SIZE bytes
+usize lz4_encode(const void *src, usize srcl, void *dst, void *work);
+//
+usize lz4_decode_file_peek_size(void *f);
+usize lz4_decode_file(void *f, void *dst);
+
+#endif
@@ -134,8 +134,8 @@ static u32 lzss_r_byte_stream(void *f, lzss_file_decoder_s *s)
 
 usize lzss_decode_file(void *f, void *dst)
 {
-    // working buffer for chunked reading
-    static u8 lzss_fbuf[4096];
+    // working buffer for chunked reading, one per thread
+    static PLTF_THREAD_LOCAL u8 lzss_fbuf[4096];
 
     lzss_header_s head = {0};
     pltf_file_r(f, &head, sizeof(lzss_header_s));
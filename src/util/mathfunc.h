@@ -71,6 +71,11 @@ static inline i32 max_i32(i32 a, i32 b)
     return (a > b ? a : b);
 }
 
+static inline u32 max_u32(u32 a, u32 b)
+{
+    return (a > b ? a : b);
+}
+
 static inline i32 max3_i32(i32 a, i32 b, i32 c)
 {
     return max_i32(a, max_i32(b, c));
@@ -6,6 +6,16 @@
 
 static u32 g_rng_seed = 213;
 
+u32 rng_seed_get()
+{
+    return g_rng_seed;
+}
+
+void rng_seed_set(u32 s)
+{
+    g_rng_seed = s;
+}
+
 // Originally based on good ol' xorshift. However, when placing tiles using
 // rng() with x and y as an input sometimes there were long strides of the
 // same tiles -> repeating. Thus I needed a better PRNG.
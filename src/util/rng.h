@@ -7,6 +7,9 @@
 
 #include "pltf/pltf.h"
 
+// state of the global generator used by the functions without a seed
+u32  rng_seed_get();
+void rng_seed_set(u32 s);
 // [0, 4294967295]
 u32 rngs_u32(u32 *s);
 u32 rng_u32();
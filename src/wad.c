@@ -6,6 +6,7 @@
 #include "app.h"
 #include "gamedef.h"
 #include "pltf/pltf.h"
+#include "util/lz4.h"
 #include "util/lzss.h"
 
 i32 wad_init_file(const void *filename)
@@ -19,12 +20,31 @@ i32 wad_init_file(const void *filename)
     i32          res = 0;
     wad_header_s wh  = {0};
 
-    if (pltf_file_rs(f, &wh, sizeof(wad_header_s))) {
+    if (!pltf_file_rs(f, &wh, sizeof(wad_header_s))) {
+        res |= WAD_ERR_RW;
+    } else if (WAD_VERSION < wh.version) {
+        res |= WAD_ERR_VERSION;
+    } else {
         spm_push();
-        usize          s_entries = sizeof(wad_el_file_s) * wh.n_entries;
         wad_el_file_s *f_entries = spm_alloct(wad_el_file_s, wh.n_entries);
+        b32            r_ok      = 0;
+
+        if (wh.version == 0) { // no codec tags: everything is LZSS
+            usize             s_entries = sizeof(wad_el_file_v0_s) * wh.n_entries;
+            wad_el_file_v0_s *v0        = spm_alloct(wad_el_file_v0_s, wh.n_entries);
+            r_ok                        = pltf_file_rs(f, v0, s_entries);
+            for (u32 n = 0; n < wh.n_entries; n++) {
+                f_entries[n].hash  = v0[n].hash;
+                f_entries[n].offs  = v0[n].offs;
+                f_entries[n].size  = v0[n].size;
+                f_entries[n].codec = WAD_CODEC_LZSS;
+            }
+        } else {
+            usize s_entries = sizeof(wad_el_file_s) * wh.n_entries;
+            r_ok            = pltf_file_rs(f, f_entries, s_entries);
+        }
 
-        if (pltf_file_rs(f, f_entries, s_entries)) {
+        if (r_ok) {
             wad_file_info_s *i = &w->files[w->n_files++];
             str_cpy(i->filename, filename);
             i->n_to = w->n_entries + wh.n_entries - 1;
@@ -35,14 +55,14 @@ i32 wad_init_file(const void *filename)
                 e->hash          = k->hash;
                 e->offs          = k->offs;
                 e->size          = k->size;
+                e->codec         = k->codec < NUM_WAD_CODECS ? k->codec
+                                                             : WAD_CODEC_LZSS;
                 e->filename      = i->filename;
             }
         } else {
             res |= WAD_ERR_RW;
         }
         spm_pop();
-    } else {
-        res |= WAD_ERR_RW;
     }
 
     if (!pltf_file_close(f)) {
@@ -118,8 +138,8 @@ void *wad_rd_spm_str(void *f, wad_el_s *efrom, const void *name)
     wad_el_s *e = wad_seek_str(f, efrom, name);
     if (!e) return 0;
 
-    void *dst = spm_alloc(e->size);
-    lzss_decode_file(f, dst);
+    void *dst = spm_alloc(wad_rd_block_peek_size(f, e));
+    wad_rd_block(f, e, dst);
     return dst;
 }
 
@@ -137,10 +157,28 @@ void *wad_rd_str(void *f, wad_el_s *efrom, const void *name, void *dst)
     wad_el_s *e = wad_seek_str(f, efrom, name);
     if (!e) return 0;
 
-    lzss_decode_file(f, dst);
+    wad_rd_block(f, e, dst);
     return dst;
 }
 
+usize wad_rd_block(void *f, wad_el_s *e, void *dst)
+{
+    switch (e->codec) {
+    case WAD_CODEC_LZ4: return lz4_decode_file(f, dst);
+    case WAD_CODEC_RAW: return (usize)pltf_file_r(f, dst, e->size);
+    default: return lzss_decode_file(f, dst);
+    }
+}
+
+usize wad_rd_block_peek_size(void *f, wad_el_s *e)
+{
+    switch (e->codec) {
+    case WAD_CODEC_LZ4: return lz4_decode_file_peek_size(f);
+    case WAD_CODEC_RAW: return e->size;
+    default: return lzss_decode_file_peek_size(f);
+    }
+}
+
 u32 wad_hash(const void *str)
 {
     const u8 *s = (const u8 *)str;
@@ -149,4 +187,78 @@ u32 wad_hash(const void *str)
         h = h * 101 + (u32)s[n];
     }
     return h;
-}
\ No newline at end of file
+}
+
+#if PLTF_DEV_ENV
+void wad_bench_codecs()
+{
+    usize n_dec    = 0;
+    usize n_lzss   = 0;
+    usize n_lz4    = 0;
+    f32   t_lzss   = 0.f;
+    f32   t_lz4    = 0.f;
+    i32   n_repeat = 8;
+
+    for (i32 n = 0; n < APP->wad.n_entries; n++) {
+        wad_el_s *e = &APP->wad.entries[n];
+        if (e->codec == WAD_CODEC_RAW) continue;
+        void *f = pltf_file_open_r((const char *)e->filename);
+        if (!f) continue;
+
+        // only consider entries which consist of exactly one block:
+        // both codecs start with {u32 nbytes, u32 size}
+        u32 head[2] = {0};
+        pltf_file_seek_set(f, e->offs);
+        pltf_file_r(f, head, sizeof(head));
+        pltf_file_seek_set(f, e->offs);
+        usize size = head[1];
+        if ((usize)head[0] + sizeof(head) != e->size ||
+            size == 0 || MMEGABYTE(1) < size) {
+            pltf_file_close(f);
+            continue;
+        }
+
+        spm_push();
+        byte *raw = (byte *)spm_alloc(size);
+        usize dec = wad_rd_block(f, e, raw);
+        pltf_file_close(f);
+        if (dec != size) {
+            spm_pop();
+            continue;
+        }
+
+        byte *b_lzss = (byte *)spm_alloc(size * 2 + 64);
+        byte *b_lz4  = (byte *)spm_alloc(lz4_encode_bound(size));
+        byte *work   = (byte *)spm_alloc(LZ4_ENCODE_WORK_SIZE);
+        usize s_lzss = lzss_encode(raw, size, b_lzss);
+        usize s_lz4  = lz4_encode(raw, size, b_lz4, work);
+
+        f32 t0 = pltf_seconds();
+        for (i32 k = 0; k < n_repeat; k++) {
+            lzss_decode(b_lzss, raw);
+        }
+        f32 t1 = pltf_seconds();
+        for (i32 k = 0; k < n_repeat; k++) {
+            lz4_decode(b_lz4, raw);
+        }
+        f32 t2 = pltf_seconds();
+        spm_pop();
+
+        n_dec += size;
+        n_lzss += s_lzss;
+        n_lz4 += s_lz4;
+        t_lzss += t1 - t0;
+        t_lz4 += t2 - t1;
+        pltf_log("WAD %08X: %7u B | LZSS %7u B | LZ4 %7u B\n",
+                 e->hash, (u32)size, (u32)s_lzss, (u32)s_lz4);
+    }
+
+    if (n_dec == 0) return;
+    f32 mb = (f32)(n_dec * n_repeat) / (f32)MMEGABYTE(1);
+    pltf_log("WAD TOTAL: %u B decoded\n", (u32)n_dec);
+    pltf_log("  LZSS: ratio %.3f, %.1f MB/s\n",
+             (f32)n_lzss / (f32)n_dec, 0.f < t_lzss ? mb / t_lzss : 0.f);
+    pltf_log("  LZ4:  ratio %.3f, %.1f MB/s\n",
+             (f32)n_lz4 / (f32)n_dec, 0.f < t_lz4 ? mb / t_lz4 : 0.f);
+}
+#endif
\ No newline at end of file
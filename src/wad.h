@@ -7,6 +7,7 @@
 
 #define WAD_NUM_FILES   8
 #define WAD_NUM_ENTRIES 4096
+#define WAD_VERSION     1 // entries carry a codec tag since version 1
 
 #include "pltf/pltf_types.h"
 
@@ -18,6 +19,15 @@ enum {
     WAD_ERR_EXISTS  = 1 << 4,
 };
 
+// how compressed blocks of an entry are decoded by the wad_rd_* functions
+enum {
+    WAD_CODEC_LZSS, // default for wad files older than version 1
+    WAD_CODEC_LZ4,
+    WAD_CODEC_RAW, // stored as is, the block is the whole entry
+    //
+    NUM_WAD_CODECS
+};
+
 typedef struct {
     u32 n_entries;
     u32 version;
@@ -27,14 +37,22 @@ typedef struct {
     u32 hash; // really a 8-character string
     u32 offs; // begin of memory block in file
     u32 size; // size of memory block
+} wad_el_file_v0_s;
+
+typedef struct {
+    u32 hash;  // really a 8-character string
+    u32 offs;  // begin of memory block in file
+    u32 size;  // size of memory block
+    u32 codec; // WAD_CODEC_*
 } wad_el_file_s;
 
 typedef struct {
     ALIGNAS(16)
     u8 *filename;
-    u32 hash; // really a 8-character string
-    u32 offs; // begin of memory block in file
-    u32 size; // size of memory block
+    u32 hash;  // really a 8-character string
+    u32 offs;  // begin of memory block in file
+    u32 size;  // size of memory block
+    u32 codec; // WAD_CODEC_*
 } wad_el_s;
 
 typedef struct {
@@ -73,6 +91,17 @@ void *wad_rd_spm_str(void *f, wad_el_s *efrom, const void *name);
 void *wad_r_str(void *f, wad_el_s *efrom, const void *name, void *dst);
 void *wad_rd_str(void *f, wad_el_s *efrom, const void *name, void *dst);
 
+// decodes a compressed block at the current file position
+// using the codec of the entry e
+usize wad_rd_block(void *f, wad_el_s *e, void *dst);
+usize wad_rd_block_peek_size(void *f, wad_el_s *e);
+
 u32 wad_hash(const void *str);
 
+#if PLTF_DEV_ENV
+// decodes all compressed entries and logs ratio and decode speed
+// of every codec for their payload
+void wad_bench_codecs();
+#endif
+
 #endif
\ No newline at end of file
@@ -0,0 +1,469 @@
+// =============================================================================
+// Copyright 2024, Lukas Wolski (the.strupf@proton.me). All rights reserved.
+// =============================================================================
+
+#include "wad_pack.h"
+#include "util/lz4.h"
+#include "util/lzss.h"
+#include "util/mathfunc.h"
+#include "util/str.h"
+#include "wad.h"
+
+#if PLTF_DEV_ENV
+
+#define WAD_PACK_CACHE_MAGIC 0x43504B57U // "WKPC"
+#define WAD_PACK_MAX_THREADS 32
+
+enum {
+    WAD_PACK_CODEC_RAW,
+    WAD_PACK_CODEC_LZSS,
+    WAD_PACK_CODEC_LZ4,
+};
+
+typedef struct {
+    u32 magic;
+    u32 version;
+    u32 n_blocks;
+} wad_pack_cache_header_s;
+
+typedef struct {
+    u64 key;
+    u32 size;
+} wad_pack_cache_el_s;
+
+typedef struct {
+    char  name[16];
+    char  path[128];
+    u32   codec;  // WAD_PACK_CODEC_*
+    u32   n_head; // leading bytes stored uncompressed
+    u8   *src;
+    usize srcl;
+    u64   key;    // content hash of codec, n_head and src
+    i32   dup;    // index of the entry with an identical payload, or -1
+    b32   cached; // block taken from the cache
+    u8   *out;    // data block as stored in the wad
+    usize outl;
+    u32   offs;
+} wad_pack_el_s;
+
+typedef struct {
+    wad_pack_el_s       *els;
+    i32                  n_els;
+    i32                 *todo; // indices of entries to encode
+    i32                  n_todo;
+    i32                  i_todo;
+    void                *mutex;
+    // previous cache
+    wad_pack_cache_el_s *cache_els;
+    u32                  n_cache_els;
+    u8                  *cache_dat;
+} wad_pack_s;
+
+static u64   wad_pack_hash(u64 h, const void *p, usize s);
+static void *wad_pack_file_r(const char *path, usize *o_size);
+static i32   wad_pack_list_parse(wad_pack_s *p, const char *list);
+static void  wad_pack_cache_r(wad_pack_s *p, const char *path);
+static i32   wad_pack_cache_w(wad_pack_s *p, const char *path);
+static i32   wad_pack_encode(wad_pack_el_s *e, void *work);
+static i32   wad_pack_thread(void *ctx);
+
+i32 wad_pack(const char *list, const char *out, i32 n_threads)
+{
+    if (!list || !out) return WAD_PACK_ERR_ARGS;
+
+    f32        t0  = pltf_seconds();
+    i32        err = 0;
+    wad_pack_s p   = {0};
+    p.els          = (wad_pack_el_s *)pltf_mem_alloc(sizeof(wad_pack_el_s) *
+                                                     WAD_NUM_ENTRIES);
+    p.todo         = (i32 *)pltf_mem_alloc(sizeof(i32) * WAD_NUM_ENTRIES);
+    if (!p.els || !p.todo) {
+        err |= WAD_PACK_ERR_MEM;
+        goto CLEANUP;
+    }
+    mclr(p.els, sizeof(wad_pack_el_s) * WAD_NUM_ENTRIES);
+
+    err |= wad_pack_list_parse(&p, list);
+    if (err) goto CLEANUP;
+
+    // read inputs and hash them
+    for (i32 n = 0; n < p.n_els; n++) {
+        wad_pack_el_s *e = &p.els[n];
+        e->dup           = -1;
+        if (str_eq(e->path, "-")) continue;
+
+        e->src = (u8 *)wad_pack_file_r(e->path, &e->srcl);
+        if (!e->src || e->srcl < e->n_head) {
+            pltf_log("wadpack: can't read %s\n", e->path);
+            err |= WAD_PACK_ERR_INPUT;
+            continue;
+        }
+        u32 k[2] = {e->codec, e->n_head};
+        e->key   = wad_pack_hash(14695981039346656037ULL, k, sizeof(k));
+        e->key   = wad_pack_hash(e->key, e->src, e->srcl);
+    }
+    if (err) goto CLEANUP;
+
+    // dedup identical payloads, look up the cache for the rest
+    FILEPATH_GEN(cachepath, out, ".cache");
+    wad_pack_cache_r(&p, cachepath);
+    usize n_dup_bytes = 0;
+    i32   n_dups      = 0;
+
+    for (i32 n = 0; n < p.n_els; n++) {
+        wad_pack_el_s *e = &p.els[n];
+        if (!e->src) continue;
+
+        for (i32 k = 0; k < n; k++) {
+            wad_pack_el_s *o = &p.els[k];
+            if (o->src && o->key == e->key && o->srcl == e->srcl &&
+                mcmp(o->src, e->src, e->srcl) == 0) {
+                e->dup = k;
+                n_dups++;
+                n_dup_bytes += e->srcl;
+                break;
+            }
+        }
+        if (0 <= e->dup) continue;
+
+        usize c_offs = 0;
+        for (u32 k = 0; k < p.n_cache_els; k++) {
+            wad_pack_cache_el_s *c = &p.cache_els[k];
+            if (c->key == e->key) {
+                e->out    = &p.cache_dat[c_offs];
+                e->outl   = c->size;
+                e->cached = 1;
+                break;
+            }
+            c_offs += c->size;
+        }
+        if (!e->cached) {
+            p.todo[p.n_todo++] = n;
+        }
+    }
+
+    // encode in parallel, the calling thread is one of the workers
+    f32 t1 = pltf_seconds();
+#if PLTF_THREADS
+    void *threads[WAD_PACK_MAX_THREADS] = {0};
+    i32   n_thrd                        = 0;
+    n_threads = clamp_i32(min_i32(n_threads, p.n_todo), 1, WAD_PACK_MAX_THREADS);
+    p.mutex   = pltf_mutex_create();
+    for (i32 n = 1; p.mutex && n < n_threads; n++) {
+        threads[n_thrd] = pltf_thread_create(wad_pack_thread, &p);
+        if (threads[n_thrd]) {
+            n_thrd++;
+        }
+    }
+#endif
+    err |= wad_pack_thread(&p);
+#if PLTF_THREADS
+    for (i32 n = 0; n < n_thrd; n++) {
+        err |= pltf_thread_join(threads[n]);
+    }
+    if (p.mutex) {
+        pltf_mutex_destroy(p.mutex);
+    }
+#endif
+    f32 t2 = pltf_seconds();
+    if (err) goto CLEANUP;
+
+    // write wad: header, entry table, unique data blocks
+    void *f = pltf_file_open_w(out);
+    if (!f) {
+        err |= WAD_PACK_ERR_OUT;
+        goto CLEANUP;
+    }
+
+    wad_header_s wh = {(u32)p.n_els, WAD_VERSION};
+    u32          pos = (u32)(sizeof(wad_header_s) +
+                    sizeof(wad_el_file_s) * (usize)p.n_els);
+    for (i32 n = 0; n < p.n_els; n++) {
+        wad_pack_el_s *e = &p.els[n];
+        if (0 <= e->dup) {
+            e->offs = p.els[e->dup].offs;
+            e->outl = p.els[e->dup].outl;
+        } else {
+            e->offs = pos;
+            pos += (u32)e->outl;
+        }
+    }
+
+    b32 w_ok = pltf_file_ws(f, &wh, sizeof(wad_header_s));
+    for (i32 n = 0; n < p.n_els; n++) {
+        wad_pack_el_s *e  = &p.els[n];
+        wad_el_file_s  ef = {0};
+        ef.hash           = wad_hash(e->name);
+        ef.offs           = e->offs;
+        ef.size           = (u32)e->outl;
+        switch (e->codec) {
+        case WAD_PACK_CODEC_RAW: ef.codec = WAD_CODEC_RAW; break;
+        case WAD_PACK_CODEC_LZSS: ef.codec = WAD_CODEC_LZSS; break;
+        case WAD_PACK_CODEC_LZ4: ef.codec = WAD_CODEC_LZ4; break;
+        }
+        w_ok &= pltf_file_ws(f, &ef, sizeof(wad_el_file_s));
+    }
+    for (i32 n = 0; n < p.n_els; n++) {
+        wad_pack_el_s *e = &p.els[n];
+        if (e->dup < 0 && e->outl) {
+            w_ok &= pltf_file_ws(f, e->out, e->outl);
+        }
+    }
+    if (!pltf_file_close(f) || !w_ok) {
+        err |= WAD_PACK_ERR_OUT;
+        goto CLEANUP;
+    }
+
+    if (wad_pack_cache_w(&p, cachepath) != 0) {
+        pltf_log("wadpack: can't write cache %s\n", cachepath);
+    }
+
+    i32 n_cached = 0;
+    for (i32 n = 0; n < p.n_els; n++) {
+        n_cached += p.els[n].cached;
+    }
+    pltf_log("wadpack: %s: %i entries, %i encoded, %i cached, %i dups "
+             "(%i KB saved), %i KB, encode %.2f s, total %.2f s\n",
+             out, p.n_els, p.n_todo, n_cached, n_dups,
+             (i32)(n_dup_bytes / 1024), (i32)(pos / 1024),
+             t2 - t1, pltf_seconds() - t0);
+
+CLEANUP:
+    for (i32 n = 0; p.els && n < p.n_els; n++) {
+        wad_pack_el_s *e = &p.els[n];
+        if (e->src) pltf_mem_free(e->src);
+        if (e->out && !e->cached) pltf_mem_free(e->out);
+    }
+    if (p.cache_els) pltf_mem_free(p.cache_els);
+    if (p.cache_dat) pltf_mem_free(p.cache_dat);
+    if (p.els) pltf_mem_free(p.els);
+    if (p.todo) pltf_mem_free(p.todo);
+    return err;
+}
+
+i32 wad_pack_cli(i32 argc, char **argv)
+{
+    if (argc < 2) {
+        pltf_log("usage: --wadpack <list.txt> <out.wad> [-j <threads>]\n");
+        return WAD_PACK_ERR_ARGS;
+    }
+
+    i32 n_threads = pltf_num_cpus();
+    for (i32 n = 2; n + 1 < argc; n++) {
+        if (str_eq(argv[n], "-j")) {
+            n_threads = 0;
+            for (const char *c = argv[n + 1]; '0' <= *c && *c <= '9'; c++) {
+                n_threads = n_threads * 10 + (i32)(*c - '0');
+            }
+        }
+    }
+    i32 err = wad_pack(argv[0], argv[1], n_threads);
+    if (err) {
+        pltf_log("wadpack: failed: %i\n", err);
+    }
+    return err;
+}
+
+static i32 wad_pack_thread(void *ctx)
+{
+    wad_pack_s *p    = (wad_pack_s *)ctx;
+    void       *work = pltf_mem_alloc(LZ4_ENCODE_WORK_SIZE);
+    i32         err  = work ? 0 : WAD_PACK_ERR_MEM;
+
+    while (!err) {
+        pltf_mutex_lock(p->mutex);
+        i32 i = p->i_todo < p->n_todo ? p->todo[p->i_todo++] : -1;
+        pltf_mutex_unlock(p->mutex);
+        if (i < 0) break;
+
+        err |= wad_pack_encode(&p->els[i], work);
+    }
+    if (work) pltf_mem_free(work);
+    return err;
+}
+
+static i32 wad_pack_encode(wad_pack_el_s *e, void *work)
+{
+    const u8 *s    = e->src + e->n_head;
+    usize     srcl = e->srcl - e->n_head;
+    usize     cap  = 0;
+
+    switch (e->codec) {
+    case WAD_PACK_CODEC_RAW: cap = srcl; break;
+    case WAD_PACK_CODEC_LZSS: cap = 8 + srcl + srcl / 8 + 16; break;
+    case WAD_PACK_CODEC_LZ4: cap = lz4_encode_bound(srcl); break;
+    }
+
+    e->out = (u8 *)pltf_mem_alloc(e->n_head + cap);
+    if (!e->out) return WAD_PACK_ERR_MEM;
+    mcpy(e->out, e->src, e->n_head);
+
+    u8 *d = e->out + e->n_head;
+    switch (e->codec) {
+    case WAD_PACK_CODEC_RAW: mcpy(d, s, srcl), e->outl = srcl; break;
+    case WAD_PACK_CODEC_LZSS: e->outl = lzss_encode(s, srcl, d); break;
+    case WAD_PACK_CODEC_LZ4: e->outl = lz4_encode(s, srcl, d, work); break;
+    }
+    e->outl += e->n_head;
+    return 0;
+}
+
+static i32 wad_pack_list_parse(wad_pack_s *p, const char *list)
+{
+    usize size = 0;
+    char *txt  = (char *)wad_pack_file_r(list, &size);
+    if (!txt) {
+        pltf_log("wadpack: can't read list %s\n", list);
+        return WAD_PACK_ERR_LIST;
+    }
+
+    i32   err  = 0;
+    i32   line = 0;
+    char *c    = txt;
+    while (*c != '\0' && !err) {
+        char *tok[4] = {0};
+        i32   n_tok  = 0;
+        line++;
+
+        // split line into whitespace separated tokens
+        while (*c != '\0' && *c != '\n') {
+            if (*c == ' ' || *c == '\t' || *c == '\r') {
+                *c++ = '\0';
+                continue;
+            }
+            if (*c == '#') { // comment until end of line
+                while (*c != '\0' && *c != '\n') {
+                    *c++ = '\0';
+                }
+                break;
+            }
+            if (n_tok < 4) {
+                tok[n_tok] = c;
+            }
+            n_tok++;
+            while (*c != '\0' && *c != '\n' && *c != ' ' && *c != '\t' && *c != '\r') {
+                c++;
+            }
+        }
+        if (*c == '\n') {
+            *c++ = '\0';
+        }
+        if (n_tok == 0) continue;
+
+        wad_pack_el_s *e = &p->els[p->n_els];
+        if (n_tok < 3 || 4 < n_tok || WAD_NUM_ENTRIES <= p->n_els) {
+            err |= WAD_PACK_ERR_LIST;
+        } else if (str_eq(tok[1], "raw")) {
+            e->codec = WAD_PACK_CODEC_RAW;
+        } else if (str_eq(tok[1], "lzss")) {
+            e->codec = WAD_PACK_CODEC_LZSS;
+        } else if (str_eq(tok[1], "lz4")) {
+            e->codec = WAD_PACK_CODEC_LZ4;
+        } else {
+            err |= WAD_PACK_ERR_LIST;
+        }
+        if (err) {
+            pltf_log("wadpack: %s:%i: expected <NAME> <raw|lzss|lz4> <path|-> [n_head]\n",
+                     list, line);
+            break;
+        }
+
+        str_cpys(e->name, sizeof(e->name), tok[0]);
+        str_cpys(e->path, sizeof(e->path), tok[2]);
+        for (const char *h = tok[3]; h && '0' <= *h && *h <= '9'; h++) {
+            e->n_head = e->n_head * 10 + (u32)(*h - '0');
+        }
+        p->n_els++;
+    }
+
+    pltf_mem_free(txt);
+    return err;
+}
+
+static void wad_pack_cache_r(wad_pack_s *p, const char *path)
+{
+    void *f = pltf_file_open_r(path);
+    if (!f) return;
+
+    wad_pack_cache_header_s h = {0};
+    if (pltf_file_rs(f, &h, sizeof(h)) &&
+        h.magic == WAD_PACK_CACHE_MAGIC &&
+        h.version == WAD_PACK_CACHE_VERSION) {
+        usize s_els = sizeof(wad_pack_cache_el_s) * h.n_blocks;
+        p->cache_els = (wad_pack_cache_el_s *)pltf_mem_alloc(s_els);
+
+        usize s_dat = 0;
+        if (p->cache_els && pltf_file_rs(f, p->cache_els, s_els)) {
+            for (u32 n = 0; n < h.n_blocks; n++) {
+                s_dat += p->cache_els[n].size;
+            }
+            p->cache_dat = (u8 *)pltf_mem_alloc(s_dat + 1);
+        }
+        if (p->cache_dat && pltf_file_rs(f, p->cache_dat, s_dat)) {
+            p->n_cache_els = h.n_blocks;
+        }
+    }
+    pltf_file_close(f);
+}
+
+static i32 wad_pack_cache_w(wad_pack_s *p, const char *path)
+{
+    void *f = pltf_file_open_w(path);
+    if (!f) return 1;
+
+    wad_pack_cache_header_s h = {WAD_PACK_CACHE_MAGIC, WAD_PACK_CACHE_VERSION, 0};
+    for (i32 n = 0; n < p->n_els; n++) {
+        wad_pack_el_s *e = &p->els[n];
+        h.n_blocks += e->src && e->dup < 0;
+    }
+
+    b32 w_ok = pltf_file_ws(f, &h, sizeof(h));
+    for (i32 n = 0; n < p->n_els; n++) {
+        wad_pack_el_s      *e = &p->els[n];
+        wad_pack_cache_el_s c = {e->key, (u32)e->outl};
+        if (e->src && e->dup < 0) {
+            w_ok &= pltf_file_ws(f, &c, sizeof(c));
+        }
+    }
+    for (i32 n = 0; n < p->n_els; n++) {
+        wad_pack_el_s *e = &p->els[n];
+        if (e->src && e->dup < 0) {
+            w_ok &= pltf_file_ws(f, e->out, e->outl);
+        }
+    }
+    w_ok &= pltf_file_close(f);
+    return (w_ok ? 0 : 1);
+}
+
+static void *wad_pack_file_r(const char *path, usize *o_size)
+{
+    void *f = pltf_file_open_r(path);
+    if (!f) return 0;
+
+    pltf_file_seek_end(f, 0);
+    i32 size = pltf_file_tell(f);
+    pltf_file_seek_set(f, 0);
+
+    // extra null-char so text files can be parsed in place
+    u8 *buf = 0 <= size ? (u8 *)pltf_mem_alloc((usize)size + 1) : 0;
+    if (buf && pltf_file_rs(f, buf, (usize)size)) {
+        buf[size] = '\0';
+        *o_size   = (usize)size;
+    } else if (buf) {
+        pltf_mem_free(buf);
+        buf = 0;
+    }
+    pltf_file_close(f);
+    return buf;
+}
+
+// 64 bit FNV-1a
+static u64 wad_pack_hash(u64 h, const void *p, usize s)
+{
+    const u8 *b = (const u8 *)p;
+    for (usize n = 0; n < s; n++) {
+        h = (h ^ b[n]) * 1099511628211ULL;
+    }
+    return h;
+}
+#endif
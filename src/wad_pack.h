@@ -0,0 +1,46 @@
+// =============================================================================
+// Copyright 2024, Lukas Wolski (the.strupf@proton.me). All rights reserved.
+// =============================================================================
+
+// Offline WAD packer (development builds only). Run the SDL executable as
+//
+//   oe --wadpack <list.txt> <out.wad> [-j <threads>]
+//
+// Every line of the list describes one entry in the order they are written:
+//
+//   # comment
+//   <NAME> <raw|lzss|lz4> <path|-> [n_head]
+//
+// - "-" creates an empty marker entry (e.g. WAD_TEX to search from)
+// - n_head leading bytes of the file are stored uncompressed in front of the
+//   compressed block (8 for textures: their w/h header)
+// - sounds are already QOA encoded and are stored raw
+//
+// Entries are compressed in parallel. Identical payloads are stored only once
+// and share the same data block. Compressed blocks are kept in <out.wad>.cache
+// keyed by a content hash of their input, so unchanged files are not
+// compressed again on the next run.
+
+#ifndef WAD_PACK_H
+#define WAD_PACK_H
+
+#include "pltf/pltf.h"
+
+#if PLTF_DEV_ENV
+#define WAD_PACK_CACHE_VERSION 1
+
+enum {
+    WAD_PACK_ERR_ARGS  = 1 << 0,
+    WAD_PACK_ERR_LIST  = 1 << 1,
+    WAD_PACK_ERR_INPUT = 1 << 2,
+    WAD_PACK_ERR_MEM   = 1 << 3,
+    WAD_PACK_ERR_OUT   = 1 << 4,
+};
+
+// returns WAD_PACK_ERR_* flags
+i32 wad_pack(const char *list, const char *out, i32 n_threads);
+// entry point for the command line, argv without the --wadpack switch
+i32 wad_pack_cli(i32 argc, char **argv);
+#endif
+
+#endif